@@ -28,6 +28,7 @@ public class ExportPak : ModuleRules
 			new string[]
             {
                 "Core",
+				"ExportPakManifest",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -48,6 +49,8 @@ public class ExportPak : ModuleRules
                 "PropertyEditor",
 				"Json",
                 "UATHelper",
+                "PakFile",
+                "TargetPlatform",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
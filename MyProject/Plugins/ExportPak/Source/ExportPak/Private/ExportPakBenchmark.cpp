@@ -0,0 +1,365 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakBenchmark.h"
+#include "ExportPak.h"
+#include "ExportPakDependencyWalker.h"
+#include "ExportPakCookedIndex.h"
+#include "ExportPakWriter.h"
+#include "ExportPakParallel.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/FileManager.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/EngineVersion.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProperties.h"
+#include "json.h"
+
+namespace ExportPakBenchmark
+{
+	static FString GetPackageName(int32 PackageIndex)
+	{
+		return FString::Printf(TEXT("/Game/Benchmark/Folder_%d/P_%d"), PackageIndex / 256, PackageIndex);
+	}
+
+	/** Edges[i] are the direct dependencies of package i, RootIndices the packages exported. */
+	static void MakeGraph(const FExportPakBenchmarkConfig& Config, TArray<TArray<int32>>& OutEdges, TArray<int32>& OutRootIndices)
+	{
+		const int32 NumPackages = Config.NumPackages;
+		const int32 NumRoots = FMath::Clamp(Config.NumRoots, 1, NumPackages);
+
+		FRandomStream RandomStream(Config.Seed);
+		OutEdges.SetNum(NumPackages);
+
+		switch (Config.Shape)
+		{
+		case EExportPakBenchmarkShape::Wide:
+		{
+			// Roots are the first packages, each one owns an equal slice of the others.
+			const int32 SliceSize = FMath::Max(1, (NumPackages - NumRoots) / NumRoots);
+			for (int32 RootIndex = 0; RootIndex < NumRoots; ++RootIndex)
+			{
+				OutRootIndices.Add(RootIndex);
+				for (int32 Index = NumRoots + RootIndex * SliceSize; Index < FMath::Min(NumPackages, NumRoots + (RootIndex + 1) * SliceSize); ++Index)
+				{
+					OutEdges[RootIndex].Add(Index);
+				}
+			}
+			break;
+		}
+
+		case EExportPakBenchmarkShape::Deep:
+		{
+			// One chain through all packages, roots enter it at evenly spaced points.
+			for (int32 Index = 0; Index + 1 < NumPackages; ++Index)
+			{
+				OutEdges[Index].Add(Index + 1);
+			}
+			for (int32 RootIndex = 0; RootIndex < NumRoots; ++RootIndex)
+			{
+				OutRootIndices.Add(NumPackages / NumRoots * RootIndex);
+			}
+			break;
+		}
+
+		case EExportPakBenchmarkShape::Shared:
+		default:
+		{
+			const int32 NumSharedPackages = FMath::Max(1, NumPackages / 20);
+			const int32 NumOwnPackages = NumPackages - NumSharedPackages;
+			for (int32 Index = 0; Index < NumOwnPackages; ++Index)
+			{
+				for (int32 EdgeIndex = 0; EdgeIndex < 3; ++EdgeIndex)
+				{
+					OutEdges[Index].AddUnique(FMath::Min(NumOwnPackages - 1, Index + RandomStream.RandRange(1, 32)));
+				}
+				OutEdges[Index].AddUnique(NumOwnPackages + RandomStream.RandRange(0, NumSharedPackages - 1));
+			}
+			for (int32 RootIndex = 0; RootIndex < NumRoots; ++RootIndex)
+			{
+				OutRootIndices.Add(NumOwnPackages / NumRoots * RootIndex);
+			}
+			break;
+		}
+		}
+	}
+
+	static void MakeCookedTree(const FExportPakBenchmarkConfig& Config, const FString& CookedProjectDirectory)
+	{
+		static const TCHAR* Extensions[] = { TEXT("uasset"), TEXT("uexp"), TEXT("ubulk") };
+
+		FRandomStream RandomStream(Config.Seed);
+		TArray<uint8> Content;
+		Content.SetNumUninitialized(Config.FileSize);
+		for (auto& Byte : Content)
+		{
+			Byte = (uint8)RandomStream.RandRange(0, 255);
+		}
+
+		ExportPakParallelFor(Config.NumPackages, 0, EAsyncExecution::ThreadPool,
+			[&Config, &CookedProjectDirectory, &Content](int32 PackageIndex)
+			{
+				// /Game/Benchmark/... is cooked to Content/Benchmark/...
+				const FString PackagePath = FPaths::Combine(CookedProjectDirectory, TEXT("Content"), GetPackageName(PackageIndex).RightChop(6));
+				for (int32 FileIndex = 0; FileIndex < FMath::Min(Config.FilesPerPackage, (int32)ARRAY_COUNT(Extensions)); ++FileIndex)
+				{
+					FFileHelper::SaveArrayToFile(Content, *(PackagePath + TEXT(".") + Extensions[FileIndex]));
+				}
+			},
+			[](int32 NumFinished) {});
+	}
+
+	static TSharedPtr<FJsonObject> MakeResult(double Seconds, int64 Items, int64 Bytes)
+	{
+		TSharedPtr<FJsonObject> ResultJsonObject = MakeShareable(new FJsonObject);
+		ResultJsonObject->SetNumberField("seconds", Seconds);
+		ResultJsonObject->SetNumberField("items", (double)Items);
+		ResultJsonObject->SetStringField("bytes", FString::Printf(TEXT("%lld"), Bytes));
+		ResultJsonObject->SetNumberField("items_per_second", Seconds > 0.0 ? Items / Seconds : 0.0);
+		ResultJsonObject->SetNumberField("megabytes_per_second", Seconds > 0.0 ? Bytes / Seconds / (1024.0 * 1024.0) : 0.0);
+		return ResultJsonObject;
+	}
+
+	/** Write every pak in parallel, like RunPakTasksInProcess. Returns the wall time. */
+	static double WritePaks(const TArray<TArray<FExportPakFileEntry>>& PakFiles, const FString& PakDirectory, int64& OutBytes)
+	{
+		FThreadSafeCounter64 Bytes;
+
+		const double StartTime = FPlatformTime::Seconds();
+		ExportPakParallelFor(PakFiles.Num(), 0, EAsyncExecution::ThreadPool,
+			[&PakFiles, &PakDirectory, &Bytes](int32 PakIndex)
+			{
+				const FString PakFilepath = FPaths::Combine(PakDirectory, FString::Printf(TEXT("%d.pak"), PakIndex));
+				FExportPakWriter Writer(PakFilepath, FExportPakWriterOptions());
+				Writer.Write(PakFiles[PakIndex]);
+				Bytes.Add(IFileManager::Get().FileSize(*PakFilepath));
+			},
+			[](int32 NumFinished) {});
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+		OutBytes = Bytes.GetValue();
+		return Seconds;
+	}
+}
+
+const TCHAR* FExportPakBenchmark::GetShapeName(EExportPakBenchmarkShape Shape)
+{
+	switch (Shape)
+	{
+	case EExportPakBenchmarkShape::Wide:	return TEXT("wide");
+	case EExportPakBenchmarkShape::Deep:	return TEXT("deep");
+	case EExportPakBenchmarkShape::Shared:	return TEXT("shared");
+	default:								return TEXT("unknown");
+	}
+}
+
+bool FExportPakBenchmark::ParseShape(const FString& ShapeName, EExportPakBenchmarkShape& OutShape)
+{
+	for (EExportPakBenchmarkShape Shape : { EExportPakBenchmarkShape::Wide, EExportPakBenchmarkShape::Deep, EExportPakBenchmarkShape::Shared })
+	{
+		if (ShapeName == GetShapeName(Shape))
+		{
+			OutShape = Shape;
+			return true;
+		}
+	}
+	return false;
+}
+
+FString FExportPakBenchmark::GetDefaultResultsFilepath()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak"), TEXT("Benchmark.json")));
+}
+
+TSharedRef<FJsonObject> FExportPakBenchmark::Run(const FExportPakBenchmarkConfig& Config)
+{
+	using namespace ExportPakBenchmark;
+
+	const FString BenchmarkDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/Benchmark")));
+	const FString CookedProjectDirectory = FPaths::Combine(BenchmarkDirectory, TEXT("Cooked"));
+	IFileManager::Get().DeleteDirectory(*BenchmarkDirectory, false, true);
+
+	TSharedRef<FJsonObject> RunJsonObject = MakeShareable(new FJsonObject);
+	{
+		TSharedPtr<FJsonObject> ConfigJsonObject = MakeShareable(new FJsonObject);
+		ConfigJsonObject->SetStringField("shape", GetShapeName(Config.Shape));
+		ConfigJsonObject->SetNumberField("packages", Config.NumPackages);
+		ConfigJsonObject->SetNumberField("roots", Config.NumRoots);
+		ConfigJsonObject->SetNumberField("files_per_package", Config.FilesPerPackage);
+		ConfigJsonObject->SetStringField("file_size_in_bytes", FString::Printf(TEXT("%lld"), Config.FileSize));
+		ConfigJsonObject->SetNumberField("seed", Config.Seed);
+		RunJsonObject->SetObjectField("config", ConfigJsonObject);
+	}
+	TSharedPtr<FJsonObject> ResultsJsonObject = MakeShareable(new FJsonObject);
+
+	TArray<TArray<int32>> Edges;
+	TArray<int32> RootIndices;
+	MakeGraph(Config, Edges, RootIndices);
+
+	TArray<FName> PackageNames;
+	TMap<FName, int32> PackageIndices;
+	for (int32 Index = 0; Index < Config.NumPackages; ++Index)
+	{
+		PackageNames.Add(FName(*GetPackageName(Index)));
+		PackageIndices.Add(PackageNames[Index], Index);
+	}
+
+	// Dependency walk, the part of GetAssetDependecies that does not depend on the asset registry.
+	TArray<TArray<FString>> RootClosures;
+	RootClosures.SetNum(RootIndices.Num());
+	{
+		int64 NumQueries = 0;
+		FExportPakDependencyWalker DependencyWalker([&Edges, &PackageNames, &PackageIndices, &NumQueries](const FName& PackageName, TArray<FName>& OutDependencies)
+		{
+			++NumQueries;
+			for (const int32 DependencyIndex : Edges[PackageIndices.FindChecked(PackageName)])
+			{
+				OutDependencies.Add(PackageNames[DependencyIndex]);
+			}
+		});
+
+		const double StartTime = FPlatformTime::Seconds();
+		int64 NumDependencies = 0;
+		for (int32 RootIndex = 0; RootIndex < RootIndices.Num(); ++RootIndex)
+		{
+			TArray<FString> OtherDependencies;
+			DependencyWalker.GatherDependencies(PackageNames[RootIndices[RootIndex]], RootClosures[RootIndex], OtherDependencies);
+			RootClosures[RootIndex].Add(PackageNames[RootIndices[RootIndex]].ToString());
+			NumDependencies += RootClosures[RootIndex].Num();
+		}
+
+		TSharedPtr<FJsonObject> ResultJsonObject = MakeResult(FPlatformTime::Seconds() - StartTime, NumDependencies, 0);
+		ResultJsonObject->SetNumberField("registry_queries", (double)NumQueries);
+		ResultsJsonObject->SetObjectField("dependency_walk", ResultJsonObject);
+	}
+
+	MakeCookedTree(Config, CookedProjectDirectory);
+
+	FExportPakCookedIndex CookedIndex;
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		CookedIndex.BuildFromDirectory(CookedProjectDirectory);
+		ResultsJsonObject->SetObjectField("cooked_index", MakeResult(FPlatformTime::Seconds() - StartTime, CookedIndex.GetNumFiles(), CookedIndex.GetTotalSize()));
+	}
+
+	// Cooked file discovery for every package of every root, as GatherCookedFilesOfPackage does it.
+	TMap<FString, TArray<FExportPakFileEntry>> PackageFiles;
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		int64 NumFiles = 0;
+		int64 NumBytes = 0;
+		for (const auto& RootClosure : RootClosures)
+		{
+			for (const auto& PackageName : RootClosure)
+			{
+				TArray<FExportPakFileEntry>& Files = PackageFiles.FindOrAdd(PackageName);
+				Files.Reset();
+
+				if (const TArray<FExportPakCookedFile>* CookedFiles = CookedIndex.FindFiles(PackageName))
+				{
+					for (const auto& CookedFile : *CookedFiles)
+					{
+						Files.Add(FExportPakFileEntry(CookedFile.Filepath, TEXT("../../../Benchmark/") + CookedFile.RelativePath, CookedFile.Size));
+						++NumFiles;
+						NumBytes += CookedFile.Size;
+					}
+				}
+			}
+		}
+		ResultsJsonObject->SetObjectField("cooked_file_discovery", MakeResult(FPlatformTime::Seconds() - StartTime, NumFiles, NumBytes));
+	}
+
+	// Individual mode with the shared store: one pak per distinct package.
+	{
+		TArray<TArray<FExportPakFileEntry>> PakFiles;
+		for (const auto& PackageFilesEntry : PackageFiles)
+		{
+			PakFiles.Add(PackageFilesEntry.Value);
+		}
+
+		int64 NumBytes = 0;
+		const double Seconds = WritePaks(PakFiles, FPaths::Combine(BenchmarkDirectory, TEXT("Individual")), NumBytes);
+		ResultsJsonObject->SetObjectField("pak_individual", MakeResult(Seconds, PakFiles.Num(), NumBytes));
+	}
+
+	// Batch mode: one pak per root with its whole closure.
+	{
+		TArray<TArray<FExportPakFileEntry>> PakFiles;
+		for (const auto& RootClosure : RootClosures)
+		{
+			TArray<FExportPakFileEntry>& Files = PakFiles[PakFiles.AddDefaulted()];
+			for (const auto& PackageName : RootClosure)
+			{
+				Files.Append(PackageFiles.FindChecked(PackageName));
+			}
+		}
+
+		int64 NumBytes = 0;
+		const double Seconds = WritePaks(PakFiles, FPaths::Combine(BenchmarkDirectory, TEXT("Batch")), NumBytes);
+		ResultsJsonObject->SetObjectField("pak_batch", MakeResult(Seconds, PakFiles.Num(), NumBytes));
+	}
+
+	RunJsonObject->SetObjectField("results", ResultsJsonObject);
+
+	IFileManager::Get().DeleteDirectory(*BenchmarkDirectory, false, true);
+
+	return RunJsonObject;
+}
+
+bool FExportPakBenchmark::SaveResults(const TArray<TSharedRef<FJsonObject>>& Results, const FString& ResultsFilepath)
+{
+	TArray<TSharedPtr<FJsonValue>> RunEntries;
+	for (const auto& Result : Results)
+	{
+		RunEntries.Add(MakeShareable(new FJsonValueObject(Result)));
+	}
+
+	TSharedPtr<FJsonObject> RootJsonObject = MakeShareable(new FJsonObject);
+	RootJsonObject->SetStringField("engine_version", FEngineVersion::Current().ToString());
+	RootJsonObject->SetStringField("platform", FPlatformProperties::PlatformName());
+	RootJsonObject->SetNumberField("logical_cores", FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+	RootJsonObject->SetArrayField("runs", RunEntries);
+
+	FString OutputString;
+	auto JsonWirter = TJsonWriterFactory<>::Create(&OutputString);
+	FJsonSerializer::Serialize(RootJsonObject.ToSharedRef(), JsonWirter);
+
+	bool bSaveSuccess = FFileHelper::SaveStringToFile(OutputString, *ResultsFilepath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	if (!bSaveSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to save benchmark results: %s"), *ResultsFilepath);
+	}
+
+	return bSaveSuccess;
+}
+
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FExportPakBenchmarkTest, "ExportPak.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+void FExportPakBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (EExportPakBenchmarkShape Shape : { EExportPakBenchmarkShape::Wide, EExportPakBenchmarkShape::Deep, EExportPakBenchmarkShape::Shared })
+	{
+		OutBeautifiedNames.Add(FExportPakBenchmark::GetShapeName(Shape));
+		OutTestCommands.Add(FExportPakBenchmark::GetShapeName(Shape));
+	}
+}
+
+bool FExportPakBenchmarkTest::RunTest(const FString& Parameters)
+{
+	FExportPakBenchmarkConfig Config;
+	if (!FExportPakBenchmark::ParseShape(Parameters, Config.Shape))
+	{
+		AddError(FString::Printf(TEXT("Unknown benchmark shape %s"), *Parameters));
+		return false;
+	}
+
+	TArray<TSharedRef<FJsonObject>> Results;
+	Results.Add(FExportPakBenchmark::Run(Config));
+
+	const FString ResultsFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak"), FString::Printf(TEXT("Benchmark_%s.json"), *Parameters));
+	TestTrue(TEXT("Save results"), FExportPakBenchmark::SaveResults(Results, ResultsFilepath));
+
+	return true;
+}
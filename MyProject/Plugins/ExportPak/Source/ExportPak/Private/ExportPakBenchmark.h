@@ -0,0 +1,67 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+
+/** How the synthetic dependency graph of a benchmark is laid out. */
+enum class EExportPakBenchmarkShape : uint8
+{
+	/** Every root depends directly on its own slice of the packages, little sharing. */
+	Wide,
+	/** Long dependency chains, the worst case for a recursive walk. */
+	Deep,
+	/** Random short edges plus a pool of common packages everything depends on, like shared materials. */
+	Shared,
+};
+
+struct FExportPakBenchmarkConfig
+{
+	FExportPakBenchmarkConfig()
+		:
+		Shape(EExportPakBenchmarkShape::Shared),
+		NumPackages(2000),
+		NumRoots(16),
+		FilesPerPackage(2),
+		FileSize(4096),
+		Seed(0x5EED)
+	{
+	}
+
+	EExportPakBenchmarkShape Shape;
+
+	int32 NumPackages;
+
+	int32 NumRoots;
+
+	/** Cooked files per package: .uasset, .uexp, then .ubulk. */
+	int32 FilesPerPackage;
+
+	int64 FileSize;
+
+	/** Graph and file content only depend on the config, so runs are comparable across releases. */
+	int32 Seed;
+};
+
+/**
+ * Times the export stages on generated data, without any project content:
+ * dependency walk, cooked tree index and file discovery, and pak generation in individual and batch mode.
+ * The synthetic cooked tree lives under Saved/ExportPak/Temp/Benchmark and is deleted afterwards.
+ */
+class FExportPakBenchmark
+{
+public:
+	/** Run one configuration. Returns its config and results. */
+	static TSharedRef<FJsonObject> Run(const FExportPakBenchmarkConfig& Config);
+
+	/** Write the results of several runs to a file, by default Saved/ExportPak/Benchmark.json. */
+	static bool SaveResults(const TArray<TSharedRef<FJsonObject>>& Results, const FString& ResultsFilepath);
+
+	static FString GetDefaultResultsFilepath();
+
+	static const TCHAR* GetShapeName(EExportPakBenchmarkShape Shape);
+
+	static bool ParseShape(const FString& ShapeName, EExportPakBenchmarkShape& OutShape);
+};
@@ -0,0 +1,262 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakCache.h"
+#include "ExportPak.h"
+#include "Misc/SecureHash.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/FileManager.h"
+#include "Templates/UniquePtr.h"
+#include "json.h"
+
+FExportPakCache::FExportPakCache(const FString& InManifestFilepath)
+	:
+	ManifestFilepath(InManifestFilepath)
+{
+}
+
+FString FExportPakCache::GetDefaultManifestFilepath()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak"), TEXT("ExportCache.json")));
+}
+
+FString FExportPakCache::HashFileWithSHA1(const FString& Filepath)
+{
+	TUniquePtr<FArchive> FileArchive(IFileManager::Get().CreateFileReader(*Filepath));
+	if (!FileArchive)
+	{
+		return FString();
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(1024 * 1024);
+
+	FSHA1 Hasher;
+	int64 RemainingSize = FileArchive->TotalSize();
+	while (RemainingSize > 0)
+	{
+		const int64 SizeToRead = FMath::Min<int64>(RemainingSize, Buffer.Num());
+		FileArchive->Serialize(Buffer.GetData(), SizeToRead);
+		if (FileArchive->IsError())
+		{
+			return FString();
+		}
+
+		Hasher.Update(Buffer.GetData(), SizeToRead);
+		RemainingSize -= SizeToRead;
+	}
+	Hasher.Final();
+
+	FSHAHash FileHash;
+	Hasher.GetHash(FileHash.Hash);
+
+	return FileHash.ToString();
+}
+
+void FExportPakCache::Load()
+{
+	PakRecords.Empty();
+	KnownInputs.Empty();
+
+	FString ManifestString;
+	if (!FFileHelper::LoadFileToString(ManifestString, *ManifestFilepath))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> RootJsonObject;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ManifestString), RootJsonObject) || !RootJsonObject.IsValid())
+	{
+		UE_LOG(LogExportPak, Warning, TEXT("Ignoring unreadable export cache %s, every pak will be rebuilt."), *ManifestFilepath);
+		return;
+	}
+
+	for (const auto& PakJsonEntry : RootJsonObject->Values)
+	{
+		const TSharedPtr<FJsonObject>* PakJsonObject = nullptr;
+		if (!PakJsonEntry.Value->TryGetObject(PakJsonObject))
+		{
+			continue;
+		}
+
+		FPakRecord& PakRecord = PakRecords.Add(PakJsonEntry.Key);
+		PakRecord.Options = (*PakJsonObject)->GetStringField("options");
+
+		for (const auto& InputJsonValue : (*PakJsonObject)->GetArrayField("inputs"))
+		{
+			const TSharedPtr<FJsonObject>& InputJsonObject = InputJsonValue->AsObject();
+
+			FInputRecord& InputRecord = PakRecord.Inputs[PakRecord.Inputs.AddDefaulted()];
+			InputRecord.SourceFilepath = InputJsonObject->GetStringField("file");
+			InputRecord.DestFilepath = InputJsonObject->GetStringField("pak_path");
+			InputRecord.Size = FCString::Atoi64(*InputJsonObject->GetStringField("file_size_in_bytes"));
+			InputRecord.TimestampTicks = FCString::Atoi64(*InputJsonObject->GetStringField("timestamp_ticks"));
+			InputRecord.Hash = InputJsonObject->GetStringField("sha1");
+			KnownInputs.Add(InputRecord.SourceFilepath, InputRecord);
+		}
+	}
+}
+
+bool FExportPakCache::Save() const
+{
+	TSharedPtr<FJsonObject> RootJsonObject = MakeShareable(new FJsonObject);
+	for (const auto& PakRecordEntry : PakRecords)
+	{
+		TSharedPtr<FJsonObject> PakJsonObject = MakeShareable(new FJsonObject);
+		PakJsonObject->SetStringField("options", PakRecordEntry.Value.Options);
+
+		TArray<TSharedPtr<FJsonValue>> InputEntries;
+		for (const auto& InputRecord : PakRecordEntry.Value.Inputs)
+		{
+			TSharedPtr<FJsonObject> InputJsonObject = MakeShareable(new FJsonObject);
+			InputJsonObject->SetStringField("file", InputRecord.SourceFilepath);
+			InputJsonObject->SetStringField("pak_path", InputRecord.DestFilepath);
+			InputJsonObject->SetStringField("file_size_in_bytes", FString::Printf(TEXT("%lld"), InputRecord.Size));
+			InputJsonObject->SetStringField("timestamp_ticks", FString::Printf(TEXT("%lld"), InputRecord.TimestampTicks));
+			InputJsonObject->SetStringField("sha1", InputRecord.Hash);
+
+			InputEntries.Add(MakeShareable(new FJsonValueObject(InputJsonObject)));
+		}
+		PakJsonObject->SetArrayField("inputs", InputEntries);
+
+		RootJsonObject->SetObjectField(PakRecordEntry.Key, PakJsonObject);
+	}
+
+	FString OutputString;
+	auto JsonWirter = TJsonWriterFactory<>::Create(&OutputString);
+	FJsonSerializer::Serialize(RootJsonObject.ToSharedRef(), JsonWirter);
+
+	bool bSaveSuccess = FFileHelper::SaveStringToFile(OutputString, *ManifestFilepath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	if (!bSaveSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to save export cache: %s"), *ManifestFilepath);
+	}
+
+	return bSaveSuccess;
+}
+
+bool FExportPakCache::MakeInputRecord(const FExportPakFileEntry& File, const FInputRecord* PreviousInput, FInputRecord& OutRecord) const
+{
+	OutRecord.SourceFilepath = File.SourceFilepath;
+	OutRecord.DestFilepath = File.DestFilepath;
+	OutRecord.Size = IFileManager::Get().FileSize(*File.SourceFilepath);
+	OutRecord.TimestampTicks = IFileManager::Get().GetTimeStamp(*File.SourceFilepath).GetTicks();
+
+	if (OutRecord.Size < 0)
+	{
+		return false;
+	}
+
+	// Untouched since the last export, trust the stored hash instead of reading the file again.
+	if (PreviousInput != nullptr && PreviousInput->Size == OutRecord.Size && PreviousInput->TimestampTicks == OutRecord.TimestampTicks)
+	{
+		OutRecord.Hash = PreviousInput->Hash;
+		return true;
+	}
+
+	OutRecord.Hash = HashFileWithSHA1(File.SourceFilepath);
+
+	return !OutRecord.Hash.IsEmpty();
+}
+
+bool FExportPakCache::IsUpToDate(const FString& PakFilepath, const TArray<FExportPakFileEntry>& Files, const FString& Options)
+{
+	// Work on copies so the inputs can be hashed without holding the lock.
+	FPakRecord PreviousRecord;
+	bool bHasPreviousRecord = false;
+	{
+		FScopeLock RecordsLock(&RecordsCritical);
+		if (const FPakRecord* FoundRecord = PakRecords.Find(PakFilepath))
+		{
+			PreviousRecord = *FoundRecord;
+			bHasPreviousRecord = true;
+		}
+	}
+
+	TMap<FString, const FInputRecord*> PreviousInputs;
+	for (const auto& PreviousInput : PreviousRecord.Inputs)
+	{
+		PreviousInputs.Add(PreviousInput.SourceFilepath, &PreviousInput);
+	}
+
+	FPakRecord StagedRecord;
+	StagedRecord.Options = Options;
+	StagedRecord.Inputs.SetNum(Files.Num());
+
+	bool bAllInputsReadable = true;
+	for (int32 Index = 0; Index < Files.Num(); ++Index)
+	{
+		const FInputRecord* const* PreviousInput = PreviousInputs.Find(Files[Index].SourceFilepath);
+		bAllInputsReadable &= MakeInputRecord(Files[Index], PreviousInput ? *PreviousInput : nullptr, StagedRecord.Inputs[Index]);
+	}
+
+	bool bUpToDate = bAllInputsReadable && bHasPreviousRecord && IFileManager::Get().FileExists(*PakFilepath)
+		&& PreviousRecord.Options == Options && PreviousRecord.Inputs.Num() == StagedRecord.Inputs.Num();
+
+	for (int32 Index = 0; bUpToDate && Index < StagedRecord.Inputs.Num(); ++Index)
+	{
+		const FInputRecord& PreviousInput = PreviousRecord.Inputs[Index];
+		const FInputRecord& CurrentInput = StagedRecord.Inputs[Index];
+		if (PreviousInput.SourceFilepath != CurrentInput.SourceFilepath || PreviousInput.DestFilepath != CurrentInput.DestFilepath || PreviousInput.Hash != CurrentInput.Hash)
+		{
+			bUpToDate = false;
+		}
+	}
+
+	FScopeLock RecordsLock(&RecordsCritical);
+	for (const auto& Input : StagedRecord.Inputs)
+	{
+		if (!Input.Hash.IsEmpty())
+		{
+			KnownInputs.Add(Input.SourceFilepath, Input);
+		}
+	}
+	StagedPakRecords.Add(PakFilepath, MoveTemp(StagedRecord));
+
+	return bUpToDate;
+}
+
+void FExportPakCache::Commit(const FString& PakFilepath)
+{
+	FScopeLock RecordsLock(&RecordsCritical);
+
+	FPakRecord StagedRecord;
+	if (StagedPakRecords.RemoveAndCopyValue(PakFilepath, StagedRecord))
+	{
+		PakRecords.Add(PakFilepath, MoveTemp(StagedRecord));
+	}
+}
+
+FString FExportPakCache::HashInput(const FExportPakFileEntry& File)
+{
+	FInputRecord PreviousInput;
+	bool bHasPreviousInput = false;
+	{
+		FScopeLock RecordsLock(&RecordsCritical);
+		if (const FInputRecord* FoundInput = KnownInputs.Find(File.SourceFilepath))
+		{
+			PreviousInput = *FoundInput;
+			bHasPreviousInput = true;
+		}
+	}
+
+	FInputRecord Input;
+	if (!MakeInputRecord(File, bHasPreviousInput ? &PreviousInput : nullptr, Input))
+	{
+		return FString();
+	}
+
+	FScopeLock RecordsLock(&RecordsCritical);
+	KnownInputs.Add(Input.SourceFilepath, Input);
+
+	return Input.Hash;
+}
+
+void FExportPakCache::Discard(const FString& PakFilepath)
+{
+	FScopeLock RecordsLock(&RecordsCritical);
+
+	StagedPakRecords.Remove(PakFilepath);
+	PakRecords.Remove(PakFilepath);
+}
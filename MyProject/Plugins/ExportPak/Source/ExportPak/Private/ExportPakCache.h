@@ -0,0 +1,78 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ExportPakWriter.h"
+#include "HAL/CriticalSection.h"
+
+/**
+ * Persistent record of what every exported pak was built from.
+ * A pak is up to date when it still exists, was built with the same options and all of its cooked inputs
+ * have the same content hash. Size and timestamp are only used to avoid rehashing untouched files.
+ * IsUpToDate() and Commit() may be called from several threads, Load() and Save() may not.
+ */
+class FExportPakCache
+{
+public:
+	explicit FExportPakCache(const FString& InManifestFilepath);
+
+	/** Saved/ExportPak/ExportCache.json */
+	static FString GetDefaultManifestFilepath();
+
+	/** SHA1 of a file's content, streamed so large .ubulk files are never fully loaded. Empty on failure. */
+	static FString HashFileWithSHA1(const FString& Filepath);
+
+	void Load();
+
+	bool Save() const;
+
+	/**
+	 * Compare the current inputs of a pak against the manifest.
+	 * The current state is staged either way, call Commit() once the pak has been rebuilt.
+	 */
+	bool IsUpToDate(const FString& PakFilepath, const TArray<FExportPakFileEntry>& Files, const FString& Options);
+
+	/** Promote the state staged by IsUpToDate() to the manifest. */
+	void Commit(const FString& PakFilepath);
+
+	/** Forget a pak, so the next export rebuilds it even if its inputs did not change. */
+	void Discard(const FString& PakFilepath);
+
+	/**
+	 * SHA1 of a cooked file, reusing the hash of any pak input recorded with the same size and timestamp.
+	 * Thread-safe, empty on failure.
+	 */
+	FString HashInput(const FExportPakFileEntry& File);
+
+private:
+	struct FInputRecord
+	{
+		FString SourceFilepath;
+		FString DestFilepath;
+		int64 Size;
+		int64 TimestampTicks;
+		FString Hash;
+	};
+
+	struct FPakRecord
+	{
+		FString Options;
+		TArray<FInputRecord> Inputs;
+	};
+
+	bool MakeInputRecord(const FExportPakFileEntry& File, const FInputRecord* PreviousInput, FInputRecord& OutRecord) const;
+
+private:
+	FString ManifestFilepath;
+
+	TMap<FString, FPakRecord> PakRecords;
+
+	TMap<FString, FPakRecord> StagedPakRecords;
+
+	/** Latest known record of every input by SourceFilepath, from the manifest and this export. */
+	TMap<FString, FInputRecord> KnownInputs;
+
+	/** Guards PakRecords, StagedPakRecords and KnownInputs, inputs are hashed outside of it. */
+	FCriticalSection RecordsCritical;
+};
@@ -0,0 +1,226 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakCommandlet.h"
+#include "ExportPak.h"
+#include "ExportPakSettings.h"
+#include "ExportPakExporter.h"
+#include "ExportPakBenchmark.h"
+#include "json.h"
+#include "AssetRegistryModule.h"
+#include "Modules/ModuleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+UExportPakCommandlet::UExportPakCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UExportPakCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	if (Switches.Contains(TEXT("benchmark")))
+	{
+		return RunBenchmark(ParamVals);
+	}
+
+	// Work on a copy so the command line never ends up in the saved project settings.
+	// NewObject takes its values from the class default object, which holds the project settings.
+	UExportPakSettings* Settings = NewObject<UExportPakSettings>(GetTransientPackage());
+	Settings->AddToRoot();
+
+	TArray<FString> RootPackages;
+	if (const FString* RootsParam = ParamVals.Find(TEXT("roots")))
+	{
+		FString Roots = *RootsParam;
+		Roots = Roots.TrimQuotes();
+		Roots.ParseIntoArray(RootPackages, TEXT(";"), true);
+	}
+
+	if (const FString* RootsFileParam = ParamVals.Find(TEXT("rootsfile")))
+	{
+		FString RootsFilepath = *RootsFileParam;
+		RootsFilepath = RootsFilepath.TrimQuotes();
+
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *RootsFilepath))
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Failed to read roots file: %s"), *RootsFilepath);
+			Settings->RemoveFromRoot();
+			return 1;
+		}
+
+		for (auto& Line : Lines)
+		{
+			Line.TrimStartAndEndInline();
+			if (!Line.IsEmpty() && !Line.StartsWith(TEXT("#")))
+			{
+				RootPackages.Add(Line);
+			}
+		}
+	}
+
+	for (const auto& RootPackage : RootPackages)
+	{
+		FFilePath PackageToExport;
+		PackageToExport.FilePath = RootPackage;
+		Settings->PackagesToExport.Add(PackageToExport);
+	}
+
+	if (const FString* PlatformsParam = ParamVals.Find(TEXT("platforms")))
+	{
+		Settings->TargetPlatforms.Empty();
+		PlatformsParam->ParseIntoArray(Settings->TargetPlatforms, TEXT("+"), true);
+	}
+
+	if (Switches.Contains(TEXT("batch")))
+	{
+		Settings->bUseBatchMode = true;
+	}
+	else if (Switches.Contains(TEXT("individual")))
+	{
+		Settings->bUseBatchMode = false;
+	}
+
+	if (Switches.Contains(TEXT("legacynamehashes")))
+	{
+		Settings->bLegacyPackageNameHashes = true;
+	}
+
+	if (Switches.Contains(TEXT("verify")))
+	{
+		Settings->bVerifyPaks = true;
+	}
+
+	if (const FString* BatchPakSizeParam = ParamVals.Find(TEXT("batchpaksize")))
+	{
+		Settings->MaxBatchPakSizeInMegabytes = FMath::Max(0, FCString::Atoi(**BatchPakSizeParam));
+	}
+
+	if (const FString* CompressionParam = ParamVals.Find(TEXT("compression")))
+	{
+		if (*CompressionParam == TEXT("None"))
+		{
+			Settings->DefaultCompression.Format = EExportPakCompressionFormat::None;
+		}
+		else if (*CompressionParam == TEXT("Zlib"))
+		{
+			Settings->DefaultCompression.Format = EExportPakCompressionFormat::Zlib;
+		}
+		else
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Unknown compression %s, expected None or Zlib."), **CompressionParam);
+			Settings->RemoveFromRoot();
+			return 1;
+		}
+	}
+
+	if (const FString* PatchBaselineParam = ParamVals.Find(TEXT("patchbaseline")))
+	{
+		Settings->bExportPatch = true;
+		Settings->PatchBaselineDirectory.Path = PatchBaselineParam->TrimQuotes();
+	}
+
+	if (const FString* FileOpenOrderParam = ParamVals.Find(TEXT("fileopenorder")))
+	{
+		Settings->FileOpenOrderLog.FilePath = FileOpenOrderParam->TrimQuotes();
+	}
+
+	if (const FString* JobsParam = ParamVals.Find(TEXT("jobs")))
+	{
+		Settings->MaxConcurrentPakJobs = FMath::Max(0, FCString::Atoi(**JobsParam));
+	}
+
+	if (const FString* ParallelRootsParam = ParamVals.Find(TEXT("parallelroots")))
+	{
+		Settings->MaxConcurrentRoots = FMath::Max(1, FCString::Atoi(**ParallelRootsParam));
+	}
+
+	if (Settings->PackagesToExport.Num() == 0)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Nothing to export, pass -roots=, -rootsfile= or fill PackagesToExport in the project settings."));
+		Settings->RemoveFromRoot();
+		return 1;
+	}
+
+	// The editor scans the asset registry in the background, a commandlet has to wait for it.
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+	AssetRegistryModule.Get().SearchAllAssets(true);
+
+	UE_LOG(LogExportPak, Display, TEXT("Exporting %d root package(s)."), Settings->PackagesToExport.Num());
+
+	FExportPakExporter Exporter(Settings);
+	const bool bSuccess = Exporter.Export();
+
+	Settings->RemoveFromRoot();
+
+	UE_LOG(LogExportPak, Display, TEXT("ExportPak %s."), bSuccess ? TEXT("succeeded") : TEXT("failed"));
+
+	return bSuccess ? 0 : 1;
+}
+
+int32 UExportPakCommandlet::RunBenchmark(const TMap<FString, FString>& ParamVals)
+{
+	FExportPakBenchmarkConfig Config;
+	if (const FString* Value = ParamVals.Find(TEXT("packages")))
+	{
+		Config.NumPackages = FMath::Max(1, FCString::Atoi(**Value));
+	}
+	if (const FString* Value = ParamVals.Find(TEXT("benchmarkroots")))
+	{
+		Config.NumRoots = FMath::Max(1, FCString::Atoi(**Value));
+	}
+	if (const FString* Value = ParamVals.Find(TEXT("filesperpackage")))
+	{
+		Config.FilesPerPackage = FMath::Max(1, FCString::Atoi(**Value));
+	}
+	if (const FString* Value = ParamVals.Find(TEXT("filesize")))
+	{
+		Config.FileSize = FMath::Max<int64>(0, FCString::Atoi64(**Value));
+	}
+	if (const FString* Value = ParamVals.Find(TEXT("seed")))
+	{
+		Config.Seed = FCString::Atoi(**Value);
+	}
+
+	TArray<FString> ShapeNames;
+	if (const FString* Value = ParamVals.Find(TEXT("shapes")))
+	{
+		Value->ParseIntoArray(ShapeNames, TEXT("+"), true);
+	}
+	else
+	{
+		ShapeNames.Add(TEXT("wide"));
+		ShapeNames.Add(TEXT("deep"));
+		ShapeNames.Add(TEXT("shared"));
+	}
+
+	TArray<TSharedRef<FJsonObject>> Results;
+	for (const auto& ShapeName : ShapeNames)
+	{
+		if (!FExportPakBenchmark::ParseShape(ShapeName, Config.Shape))
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Unknown benchmark shape %s, expected wide, deep or shared."), *ShapeName);
+			return 1;
+		}
+
+		UE_LOG(LogExportPak, Display, TEXT("Benchmark %s: %d package(s), %d root(s)."), *ShapeName, Config.NumPackages, Config.NumRoots);
+		Results.Add(FExportPakBenchmark::Run(Config));
+	}
+
+	FString ResultsFilepath = FExportPakBenchmark::GetDefaultResultsFilepath();
+	if (const FString* Value = ParamVals.Find(TEXT("output")))
+	{
+		ResultsFilepath = Value->TrimQuotes();
+	}
+
+	return FExportPakBenchmark::SaveResults(Results, ResultsFilepath) ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ExportPakCommandlet.generated.h"
+
+/**
+ * Headless entry point of the export pipeline, for build machines.
+ *
+ * UE4Editor-Cmd MyProject.uproject -run=ExportPak -roots=/Game/Maps/MapA;/Game/Maps/MapB -unattended -nullrhi
+ *
+ * -roots=<a;b;...>		Root packages, in addition to or instead of PackagesToExport in the project settings.
+ * -rootsfile=<path>	Text file with one root package per line, '#' starts a comment line.
+ * -platforms=<a+b+...>	Override TargetPlatforms, e.g. WindowsNoEditor+LinuxNoEditor.
+ * -batch / -individual	Override bUseBatchMode.
+ * -batchpaksize=<MB>	Override MaxBatchPakSizeInMegabytes.
+ * -compression=<codec>	Override the format of DefaultCompression, None or Zlib.
+ * -jobs=<n>			Override MaxConcurrentPakJobs.
+ * -parallelroots=<n>	Override MaxConcurrentRoots.
+ *
+ * Returns 0 when every pak and description file was written.
+ *
+ * With -benchmark it exports nothing and runs FExportPakBenchmark on generated data instead:
+ * -shapes=<wide+deep+shared> -packages=<n> -benchmarkroots=<n> -filesperpackage=<n> -filesize=<bytes> -seed=<n> -output=<json path>
+ */
+UCLASS()
+class UExportPakCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UExportPakCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	int32 RunBenchmark(const TMap<FString, FString>& ParamVals);
+};
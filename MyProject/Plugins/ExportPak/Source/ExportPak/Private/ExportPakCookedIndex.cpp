@@ -0,0 +1,142 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakCookedIndex.h"
+#include "ExportPak.h"
+#include "PlatformFile.h"
+#include "PlatformFilemanager.h"
+#include "FileHelper.h"
+#include "FileManager.h"
+#include "PackageName.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+
+class FCookedIndexVisitor : public IPlatformFile::FDirectoryStatVisitor
+{
+public:
+	FCookedIndexVisitor(const FString& InCookedProjectDirectory, TMap<FString, TArray<FExportPakCookedFile>>& InPackageFiles)
+		:
+		CookedProjectDirectory(InCookedProjectDirectory),
+		PackageFiles(InPackageFiles)
+	{
+	}
+
+	virtual bool Visit(const TCHAR* FilenameOrDirectory, const FFileStatData& StatData) override
+	{
+		if (StatData.bIsDirectory)
+		{
+			return true;
+		}
+
+		FExportPakCookedFile CookedFile;
+		CookedFile.Filepath = FilenameOrDirectory;
+		FPaths::MakeStandardFilename(CookedFile.Filepath);
+		CookedFile.RelativePath = FilenameOrDirectory;
+		FPaths::MakePathRelativeTo(CookedFile.RelativePath, *CookedProjectDirectory);
+		CookedFile.Size = StatData.FileSize;
+
+		// .uasset, .uexp, .ubulk, .umap... of the same package all share the key.
+		PackageFiles.FindOrAdd(FPaths::GetBaseFilename(CookedFile.RelativePath, false)).Add(CookedFile);
+
+		return true;
+	}
+
+private:
+	FString CookedProjectDirectory;
+
+	TMap<FString, TArray<FExportPakCookedFile>>& PackageFiles;
+};
+
+void FExportPakCookedIndex::Build(const FString& CookedPlatformName)
+{
+	FString ProjectName = FPaths::GetBaseFilename(FPaths::GetProjectFilePath());
+	BuildFromDirectory(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Cooked"), CookedPlatformName, ProjectName));
+}
+
+void FExportPakCookedIndex::BuildFromDirectory(const FString& InCookedProjectDirectory)
+{
+	// Trailing slash, so MakePathRelativeTo treats it as a directory.
+	CookedProjectDirectory = FPaths::ConvertRelativePathToFull(InCookedProjectDirectory) / TEXT("");
+	PackageFiles.Empty();
+	NumFiles = 0;
+	TotalSize = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	FCookedIndexVisitor Visitor(CookedProjectDirectory, PackageFiles);
+	FPlatformFileManager::Get().GetPlatformFile().IterateDirectoryStatRecursively(*CookedProjectDirectory, Visitor);
+
+	for (const auto& PackageFilesEntry : PackageFiles)
+	{
+		for (const auto& CookedFile : PackageFilesEntry.Value)
+		{
+			++NumFiles;
+			TotalSize += CookedFile.Size;
+		}
+	}
+
+	UE_LOG(LogExportPak, Log, TEXT("Indexed %d cooked package(s) in %s in %.3f s."), PackageFiles.Num(), *CookedProjectDirectory, FPlatformTime::Seconds() - StartTime);
+}
+
+bool FExportPakCookedIndex::GetPackageKey(const FString& LongPackageName, FString& OutPackageKey)
+{
+	FString PackageFilepath;
+	if (!FPackageName::TryConvertLongPackageNameToFilename(LongPackageName, PackageFilepath))
+	{
+		return false;
+	}
+
+	// ../../../MyProject/Content/Maps/NewMap -> Content/Maps/NewMap
+	FPaths::MakePathRelativeTo(PackageFilepath, *FPaths::ProjectDir());
+	OutPackageKey = PackageFilepath;
+
+	return true;
+}
+
+const TArray<FExportPakCookedFile>* FExportPakCookedIndex::FindFiles(const FString& LongPackageName) const
+{
+	FString PackageKey;
+	if (!GetPackageKey(LongPackageName, PackageKey))
+	{
+		return nullptr;
+	}
+
+	return PackageFiles.Find(PackageKey);
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakCookedIndexTest, "ExportPak.CookedIndex", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakCookedIndexTest::RunTest(const FString& Parameters)
+{
+	const FString CookedProjectDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/CookedIndexTest"));
+	IFileManager::Get().DeleteDirectory(*CookedProjectDirectory, false, true);
+
+	FFileHelper::SaveStringToFile(TEXT("uasset"), *FPaths::Combine(CookedProjectDirectory, TEXT("Content/Maps/NewMap.umap")));
+	FFileHelper::SaveStringToFile(TEXT("uexp!"), *FPaths::Combine(CookedProjectDirectory, TEXT("Content/Maps/NewMap.uexp")));
+	FFileHelper::SaveStringToFile(TEXT("other"), *FPaths::Combine(CookedProjectDirectory, TEXT("Content/Maps/NewMap_BuiltData.uasset")));
+
+	FExportPakCookedIndex CookedIndex;
+	CookedIndex.BuildFromDirectory(CookedProjectDirectory);
+
+	TestEqual(TEXT("Packages"), CookedIndex.GetNumPackages(), 2);
+
+	const TArray<FExportPakCookedFile>* Files = CookedIndex.FindFiles(TEXT("/Game/Maps/NewMap"));
+	if (Files == nullptr)
+	{
+		AddError(TEXT("/Game/Maps/NewMap is missing from the index"));
+	}
+	else
+	{
+		TestEqual(TEXT("Files of /Game/Maps/NewMap"), Files->Num(), 2);
+		for (const auto& File : *Files)
+		{
+			TestEqual(TEXT("Size"), File.Size, IFileManager::Get().FileSize(*File.Filepath));
+			TestTrue(TEXT("Relative path"), File.RelativePath.StartsWith(TEXT("Content/Maps/NewMap.")));
+		}
+	}
+
+	TestNull(TEXT("Not cooked"), CookedIndex.FindFiles(TEXT("/Game/Maps/Missing")));
+
+	IFileManager::Get().DeleteDirectory(*CookedProjectDirectory, false, true);
+
+	return true;
+}
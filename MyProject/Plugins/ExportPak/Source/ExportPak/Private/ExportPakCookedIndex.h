@@ -0,0 +1,69 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A file of the cooked output, e.g. the .uexp of a package. */
+struct FExportPakCookedFile
+{
+	/** Standardized path of the cooked file on disk. */
+	FString Filepath;
+
+	/** Path relative to the cooked project directory, e.g. Content/Maps/NewMap.umap */
+	FString RelativePath;
+
+	int64 Size;
+};
+
+/**
+ * Every cooked file of a project for one platform, grouped by package.
+ * Built with a single walk of Saved/Cooked/<Platform>/<Project>, so looking up the files of a package
+ * never touches the file system again. Read-only once built, so it can be shared between threads.
+ */
+class FExportPakCookedIndex
+{
+public:
+	FExportPakCookedIndex()
+		:
+		NumFiles(0),
+		TotalSize(0)
+	{
+	}
+
+	/** Walk Saved/Cooked/<CookedPlatformName>/<Project>. */
+	void Build(const FString& CookedPlatformName);
+
+	/** Walk an arbitrary cooked project directory, the one that holds Content/. */
+	void BuildFromDirectory(const FString& InCookedProjectDirectory);
+
+	/** Cooked files of a long package name like /Game/Maps/NewMap, all extensions. Null if it was not cooked. */
+	const TArray<FExportPakCookedFile>* FindFiles(const FString& LongPackageName) const;
+
+	int32 GetNumPackages() const
+	{
+		return PackageFiles.Num();
+	}
+
+	int64 GetNumFiles() const
+	{
+		return NumFiles;
+	}
+
+	int64 GetTotalSize() const
+	{
+		return TotalSize;
+	}
+
+	/** Key of a package: path relative to the cooked project directory without extension, e.g. Content/Maps/NewMap */
+	static bool GetPackageKey(const FString& LongPackageName, FString& OutPackageKey);
+
+private:
+	FString CookedProjectDirectory;
+
+	TMap<FString, TArray<FExportPakCookedFile>> PackageFiles;
+
+	int64 NumFiles;
+
+	int64 TotalSize;
+};
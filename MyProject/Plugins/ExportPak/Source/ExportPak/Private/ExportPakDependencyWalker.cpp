@@ -0,0 +1,245 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakDependencyWalker.h"
+#include "ExportPak.h"
+#include "Math/RandomStream.h"
+#include "HAL/PlatformTime.h"
+
+FExportPakDependencyWalker::FExportPakDependencyWalker(const FGetDependencies& InGetDependencies)
+	:
+	GetDependencies(InGetDependencies),
+	VisitGeneration(0)
+{
+}
+
+int32 FExportPakDependencyWalker::FindOrAddNode(const FName& PackageName)
+{
+	if (const int32* NodeIndex = NodeIndices.Find(PackageName))
+	{
+		return *NodeIndex;
+	}
+
+	const int32 NodeIndex = Nodes.AddDefaulted();
+	FNode& Node = Nodes[NodeIndex];
+	Node.PackageName = PackageName;
+	Node.PackageNameString = PackageName.ToString();
+	Node.bIsInGameContentDir = Node.PackageNameString.StartsWith("/Game");
+	Node.bDependenciesGathered = false;
+	Node.bClosureGathered = false;
+	Node.VisitedGeneration = 0;
+
+	NodeIndices.Add(PackageName, NodeIndex);
+
+	return NodeIndex;
+}
+
+void FExportPakDependencyWalker::GatherDirectDependencies(int32 NodeIndex)
+{
+	if (Nodes[NodeIndex].bDependenciesGathered)
+	{
+		return;
+	}
+
+	DependencyNames.Reset();
+	GetDependencies(Nodes[NodeIndex].PackageName, DependencyNames);
+
+	// FindOrAddNode may grow Nodes, so never hold a reference to a node across it.
+	TArray<int32> Dependencies;
+	Dependencies.Reserve(DependencyNames.Num());
+	for (const auto& DependencyName : DependencyNames)
+	{
+		Dependencies.Add(FindOrAddNode(DependencyName));
+	}
+
+	Nodes[NodeIndex].Dependencies = MoveTemp(Dependencies);
+	Nodes[NodeIndex].bDependenciesGathered = true;
+}
+
+const TArray<int32>& FExportPakDependencyWalker::GatherClosure(int32 RootNodeIndex)
+{
+	if (Nodes[RootNodeIndex].bClosureGathered)
+	{
+		return Nodes[RootNodeIndex].Closure;
+	}
+
+	++VisitGeneration;
+
+	struct FStackFrame
+	{
+		int32 NodeIndex;
+		int32 NextDependency;
+	};
+
+	TArray<int32> Closure;
+	TArray<FStackFrame> Stack;
+	Stack.Add({ RootNodeIndex, 0 });
+
+	while (Stack.Num() > 0)
+	{
+		const int32 NodeIndex = Stack.Last().NodeIndex;
+		GatherDirectDependencies(NodeIndex);
+
+		const int32 DependencyIndex = Stack.Last().NextDependency++;
+		if (DependencyIndex >= Nodes[NodeIndex].Dependencies.Num())
+		{
+			Stack.Pop(false);
+			continue;
+		}
+
+		const int32 ChildIndex = Nodes[NodeIndex].Dependencies[DependencyIndex];
+		if (Nodes[ChildIndex].VisitedGeneration == VisitGeneration)
+		{
+			continue;
+		}
+
+		Nodes[ChildIndex].VisitedGeneration = VisitGeneration;
+		Closure.Add(ChildIndex);
+
+		if (Nodes[ChildIndex].bClosureGathered)
+		{
+			// Walked as a root before, reuse its closure instead of descending again.
+			for (const int32 ClosureIndex : Nodes[ChildIndex].Closure)
+			{
+				if (Nodes[ClosureIndex].VisitedGeneration != VisitGeneration)
+				{
+					Nodes[ClosureIndex].VisitedGeneration = VisitGeneration;
+					Closure.Add(ClosureIndex);
+				}
+			}
+		}
+		else
+		{
+			Stack.Add({ ChildIndex, 0 });
+		}
+	}
+
+	FNode& RootNode = Nodes[RootNodeIndex];
+	RootNode.Closure = MoveTemp(Closure);
+	RootNode.bClosureGathered = true;
+
+	return RootNode.Closure;
+}
+
+void FExportPakDependencyWalker::GatherDependencies(const FName& RootPackageName, TArray<FString>& OutDependenciesInGameContentDir, TArray<FString>& OutOtherDependencies)
+{
+	const int32 RootNodeIndex = FindOrAddNode(RootPackageName);
+	const TArray<int32>& Closure = GatherClosure(RootNodeIndex);
+
+	for (const int32 NodeIndex : Closure)
+	{
+		const FNode& Node = Nodes[NodeIndex];
+		if (Node.bIsInGameContentDir)
+		{
+			OutDependenciesInGameContentDir.Add(Node.PackageNameString);
+		}
+		else
+		{
+			OutOtherDependencies.Add(Node.PackageNameString);
+		}
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakDependencyWalkerBenchmark, "ExportPak.DependencyWalker.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakDependencyWalkerBenchmark::RunTest(const FString& Parameters)
+{
+	// Synthetic graph: a long chain (deep recursion), short random forward edges, a few back edges (cycles)
+	// and a block of "common materials" everything depends on.
+	const int32 NumNodes = 100000;
+	const int32 NumSharedNodes = 1000;
+	const int32 NumRoots = 32;
+
+	FRandomStream RandomStream(0x5EED);
+	TArray<FName> NodeNames;
+	TArray<TArray<FName>> Edges;
+	NodeNames.Reserve(NumNodes);
+	Edges.SetNum(NumNodes);
+
+	for (int32 Index = 0; Index < NumNodes; ++Index)
+	{
+		NodeNames.Add(FName(*FString::Printf(Index % 10 == 0 ? TEXT("/Script/Synthetic%d") : TEXT("/Game/Synthetic/Node_%d"), Index)));
+	}
+
+	TMap<FName, int32> NameToIndex;
+	for (int32 Index = 0; Index < NumNodes; ++Index)
+	{
+		NameToIndex.Add(NodeNames[Index], Index);
+
+		if (Index + 1 < NumNodes)
+		{
+			Edges[Index].Add(NodeNames[Index + 1]);
+		}
+		for (int32 EdgeIndex = 0; EdgeIndex < 3; ++EdgeIndex)
+		{
+			Edges[Index].Add(NodeNames[FMath::Min(NumNodes - 1, Index + RandomStream.RandRange(1, 64))]);
+		}
+		Edges[Index].Add(NodeNames[NumNodes - NumSharedNodes + RandomStream.RandRange(0, NumSharedNodes - 1)]);
+		if (Index % 997 == 0 && Index > 0)
+		{
+			Edges[Index].Add(NodeNames[RandomStream.RandRange(0, Index - 1)]);
+		}
+	}
+
+	int32 NumQueries = 0;
+	auto GetSyntheticDependencies = [&Edges, &NameToIndex, &NumQueries](const FName& PackageName, TArray<FName>& OutDependencies)
+	{
+		++NumQueries;
+		OutDependencies.Append(Edges[NameToIndex.FindChecked(PackageName)]);
+	};
+
+	FExportPakDependencyWalker Walker(GetSyntheticDependencies);
+
+	// Roots spread over the graph so their closures overlap heavily, like maps sharing props.
+	TArray<int32> RootIndices;
+	for (int32 RootIndex = 0; RootIndex < NumRoots; ++RootIndex)
+	{
+		RootIndices.Add((NumNodes - NumSharedNodes) / NumRoots * (NumRoots - 1 - RootIndex));
+	}
+
+	TArray<TArray<FString>> GameClosures;
+	TArray<TArray<FString>> OtherClosures;
+	GameClosures.SetNum(NumRoots);
+	OtherClosures.SetNum(NumRoots);
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 RootIndex = 0; RootIndex < NumRoots; ++RootIndex)
+	{
+		Walker.GatherDependencies(NodeNames[RootIndices[RootIndex]], GameClosures[RootIndex], OtherClosures[RootIndex]);
+	}
+	const double WalkTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogExportPak, Display, TEXT("DependencyWalker benchmark: %d nodes, %d roots, %d registry queries, %.3f s."), NumNodes, NumRoots, NumQueries, WalkTime);
+	TestTrue(TEXT("Every package queried at most once"), NumQueries <= NumNodes);
+
+	// Check a few closures against a plain set-based BFS.
+	for (int32 RootIndex = 0; RootIndex < NumRoots; RootIndex += NumRoots / 4)
+	{
+		TSet<int32> Expected;
+		TArray<int32> Queue;
+		Queue.Add(RootIndices[RootIndex]);
+		for (int32 QueueIndex = 0; QueueIndex < Queue.Num(); ++QueueIndex)
+		{
+			for (const auto& Dependency : Edges[Queue[QueueIndex]])
+			{
+				const int32 DependencyIndex = NameToIndex.FindChecked(Dependency);
+				if (!Expected.Contains(DependencyIndex))
+				{
+					Expected.Add(DependencyIndex);
+					Queue.Add(DependencyIndex);
+				}
+			}
+		}
+
+		TestEqual(TEXT("Closure size"), GameClosures[RootIndex].Num() + OtherClosures[RootIndex].Num(), Expected.Num());
+		for (const auto& PackageName : GameClosures[RootIndex])
+		{
+			if (!Expected.Contains(NameToIndex.FindChecked(FName(*PackageName))))
+			{
+				AddError(FString::Printf(TEXT("Unexpected dependency %s"), *PackageName));
+				break;
+			}
+		}
+	}
+
+	return true;
+}
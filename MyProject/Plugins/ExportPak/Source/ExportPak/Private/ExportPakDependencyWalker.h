@@ -0,0 +1,66 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Computes the transitive dependencies of packages with an explicit stack, so deep graphs cannot overflow the call stack.
+ *
+ * One walker is meant to live for a whole export:
+ * - the direct dependencies of every package are queried once and kept, however many roots reach it,
+ * - the closure of every walked root is kept, and a later walk that reaches that root splices it in instead of walking it again.
+ */
+class FExportPakDependencyWalker
+{
+public:
+	/** Returns the direct dependencies of a package, e.g. from the asset registry. */
+	typedef TFunction<void(const FName& PackageName, TArray<FName>& OutDependencies)> FGetDependencies;
+
+	explicit FExportPakDependencyWalker(const FGetDependencies& InGetDependencies);
+
+	/**
+	 * Gather everything RootPackageName depends on, directly or not.
+	 * Packages under /Game go to OutDependenciesInGameContentDir, everything else to OutOtherDependencies.
+	 * The root itself is only listed if it is part of a dependency cycle.
+	 */
+	void GatherDependencies(const FName& RootPackageName, TArray<FString>& OutDependenciesInGameContentDir, TArray<FString>& OutOtherDependencies);
+
+	/** Number of distinct packages seen so far. */
+	int32 GetNumPackages() const { return Nodes.Num(); }
+
+private:
+	struct FNode
+	{
+		FName PackageName;
+		FString PackageNameString;
+		bool bIsInGameContentDir;
+
+		bool bDependenciesGathered;
+		TArray<int32> Dependencies;
+
+		bool bClosureGathered;
+		TArray<int32> Closure;
+
+		/** Equal to VisitGeneration when visited by the current walk, saves clearing a visited set per root. */
+		uint32 VisitedGeneration;
+	};
+
+	int32 FindOrAddNode(const FName& PackageName);
+
+	void GatherDirectDependencies(int32 NodeIndex);
+
+	const TArray<int32>& GatherClosure(int32 RootNodeIndex);
+
+private:
+	FGetDependencies GetDependencies;
+
+	TArray<FNode> Nodes;
+
+	TMap<FName, int32> NodeIndices;
+
+	uint32 VisitGeneration;
+
+	/** Scratch buffer for the provider, reused for every package. */
+	TArray<FName> DependencyNames;
+};
@@ -0,0 +1,2056 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakExporter.h"
+#include "ExportPak.h"
+#include "ExportPakSettings.h"
+#include "ExportPakProcessPool.h"
+#include "ExportPakWriter.h"
+#include "ExportPakCache.h"
+#include "ExportPakDependencyWalker.h"
+#include "ExportPakParallel.h"
+#include "ExportPakCookedIndex.h"
+#include "ExportPakResponseFile.h"
+#include "ExportPakStats.h"
+#include "ExportPakManifest.h"
+#include "ExportPakManifestWriter.h"
+#include "ExportPakJsonFile.h"
+#include "ExportPakPatch.h"
+#include "ExportPakNameHashCache.h"
+#include "ExportPakFileOrder.h"
+#include "ExportPakVerifier.h"
+#include "AssetRegistryModule.h"
+#include "IPlatformFilePak.h"
+#include "ModuleManager.h"
+#include "PlatformFile.h"
+#include "PlatformFilemanager.h"
+#include "FileHelper.h"
+#include "json.h"
+#include "Misc/SecureHash.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Misc/ScopeLock.h"
+#include "FileManager.h"
+#include "Templates/UniquePtr.h"
+#include "HAL/PlatformMemory.h"
+#include "Async/ParallelFor.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "Interfaces/ITargetPlatformManagerModule.h"
+
+FString HashStringWithSHA1(const FString &InString, EExportPakNameHash NameHash)
+{
+	// The manifest reader has to find paks by the same hash. Formatted outside the cache lock.
+	return FExportPakNameHashCache::Get(NameHash).Hash(InString).ToString();
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHashStringWithSHA1Test, "ExportPak.HashStringWithSHA1", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FHashStringWithSHA1Test::RunTest(const FString& Parameters)
+{
+	FString S = "/Game/MyProject/Maps/MyTestMap";
+	FString HashString = HashStringWithSHA1(S);
+
+	UE_LOG(LogExportPak, Log, TEXT("%s -> %s"), *S, *HashString);
+
+	return HashString.ToLower() == "eb397865ca4d6f2d48fb44a45424cff0fe60541e";
+}
+
+/** FScopedSlowTask only works on the game thread. Roots exported on other threads just log. */
+class FExportPakProgress
+{
+public:
+	explicit FExportPakProgress(float AmountOfWork)
+	{
+		if (IsInGameThread())
+		{
+			SlowTask.Reset(new FScopedSlowTask(AmountOfWork));
+			SlowTask->MakeDialog();
+		}
+	}
+
+	void EnterProgressFrame(float ExpectedWorkThisFrame, const FText& Text)
+	{
+		if (SlowTask)
+		{
+			SlowTask->EnterProgressFrame(ExpectedWorkThisFrame, Text);
+		}
+	}
+
+private:
+	TUniquePtr<FScopedSlowTask> SlowTask;
+};
+
+/** One pak to produce and the cooked files that go into it. */
+struct FExportPakTask
+{
+	/** Used for logging and progress, normally the long package name the pak is built for. */
+	FString Name;
+
+	/** SHA1 of Name, used for the pak file name and the temporary response and log files. */
+	FString HashedName;
+
+	FString OutputPakFilepath;
+
+	/** Cooked platform the files come from, tasks of every platform run in the same pool. */
+	FString CookedPlatformName;
+
+	/** UnrealPak options for that platform, also part of the export cache key. */
+	FString UnrealPakOptions;
+
+	/** Long package names whose cooked files are in Files. */
+	TArray<FString> Packages;
+
+	/** Files carry their own CompressionMethod, the block size is shared by the whole pak. */
+	TArray<FExportPakFileEntry> Files;
+
+	int32 CompressionBlockSize;
+
+	/** Set for the paks of Settings->GroupingRules with a GroupName. */
+	FString GroupName;
+
+	/** One of the paks AddBatchPakTask() splits the ungrouped packages of a root into. */
+	bool bBatchChunk;
+
+	/** An individual pak in the shared store, claimed in FExportPakExporter::SharedPaks. */
+	bool bSharedStorePak;
+
+	/** Files the file open order log placed, 0 if the files are in discovery order. */
+	int32 NumFilesInOpenOrder;
+
+	/** Seeks of reading the logged files in open order, in discovery order and in the final layout. */
+	int32 SeeksBeforeOpenOrder;
+	int32 SeeksInOpenOrder;
+
+	FExportPakTask()
+		:
+		CompressionBlockSize(0),
+		bBatchChunk(false),
+		bSharedStorePak(false),
+		NumFilesInOpenOrder(0),
+		SeeksBeforeOpenOrder(0),
+		SeeksInOpenOrder(0)
+	{
+	}
+};
+
+/** Index of the first rule that takes the package, INDEX_NONE if none does. */
+int32 FindGroupingRule(const TArray<FExportPakGroupingRule>& Rules, const FString& PackageName, const FString& AssetClass)
+{
+	for (int32 RuleIndex = 0; RuleIndex < Rules.Num(); ++RuleIndex)
+	{
+		const FExportPakGroupingRule& Rule = Rules[RuleIndex];
+		if (Rule.AssetClasses.Num() > 0 && !Rule.AssetClasses.Contains(AssetClass))
+		{
+			continue;
+		}
+
+		const bool bPathMatches = Rule.PathPrefixes.Num() == 0 || Rule.PathPrefixes.ContainsByPredicate([&PackageName](const FString& PathPrefix)
+		{
+			return PackageName.StartsWith(PathPrefix);
+		});
+		if (bPathMatches)
+		{
+			return RuleIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakGroupingRulesTest, "ExportPak.GroupingRules", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakGroupingRulesTest::RunTest(const FString& Parameters)
+{
+	TArray<FExportPakGroupingRule> Rules;
+
+	FExportPakGroupingRule& MeshRule = Rules[Rules.AddDefaulted()];
+	MeshRule.AssetClasses = { TEXT("StaticMesh"), TEXT("Material") };
+	MeshRule.GroupName = TEXT("Meshes");
+
+	FExportPakGroupingRule& AudioRule = Rules[Rules.AddDefaulted()];
+	AudioRule.PathPrefixes = { TEXT("/Game/Audio/") };
+	AudioRule.GroupName = TEXT("Audio");
+
+	FExportPakGroupingRule& TextureRule = Rules[Rules.AddDefaulted()];
+	TextureRule.AssetClasses = { TEXT("Texture2D") };
+	TextureRule.PathPrefixes = { TEXT("/Game/Textures/"), TEXT("/Game/UI/") };
+
+	TestEqual(TEXT("Class only rule"), FindGroupingRule(Rules, TEXT("/Game/Props/Rock"), TEXT("StaticMesh")), 0);
+	TestEqual(TEXT("Path only rule"), FindGroupingRule(Rules, TEXT("/Game/Audio/Bank"), TEXT("SoundWave")), 1);
+	TestEqual(TEXT("First matching rule wins"), FindGroupingRule(Rules, TEXT("/Game/Audio/Mesh"), TEXT("Material")), 0);
+	TestEqual(TEXT("Class and path rule"), FindGroupingRule(Rules, TEXT("/Game/UI/Icon"), TEXT("Texture2D")), 2);
+	TestEqual(TEXT("Class and path must both match"), FindGroupingRule(Rules, TEXT("/Game/Props/Rock_D"), TEXT("Texture2D")), (int32)INDEX_NONE);
+	TestEqual(TEXT("Unknown class"), FindGroupingRule(Rules, TEXT("/Game/Props/Rock"), FString()), (int32)INDEX_NONE);
+
+	return true;
+}
+
+/**
+ * First-fit decreasing bin packing of items into chunks of at most MaxChunkSize.
+ * An item larger than MaxChunkSize gets a chunk of its own. MaxChunkSize <= 0 puts everything into one chunk.
+ * Items keep their relative order inside a chunk.
+ */
+void PackIntoChunks(const TArray<int64>& ItemSizes, int64 MaxChunkSize, TArray<TArray<int32>>& OutChunks)
+{
+	if (MaxChunkSize <= 0)
+	{
+		TArray<int32>& Chunk = OutChunks[OutChunks.AddDefaulted()];
+		for (int32 ItemIndex = 0; ItemIndex < ItemSizes.Num(); ++ItemIndex)
+		{
+			Chunk.Add(ItemIndex);
+		}
+		return;
+	}
+
+	TArray<int32> SortedItems;
+	for (int32 ItemIndex = 0; ItemIndex < ItemSizes.Num(); ++ItemIndex)
+	{
+		SortedItems.Add(ItemIndex);
+	}
+	SortedItems.StableSort([&ItemSizes](int32 A, int32 B) { return ItemSizes[A] > ItemSizes[B]; });
+
+	TArray<int64> ChunkSizes;
+	for (const int32 ItemIndex : SortedItems)
+	{
+		const int64 ItemSize = FMath::Max<int64>(ItemSizes[ItemIndex], 0);
+
+		int32 ChunkIndex = 0;
+		while (ChunkIndex < ChunkSizes.Num() && ChunkSizes[ChunkIndex] + ItemSize > MaxChunkSize)
+		{
+			++ChunkIndex;
+		}
+
+		if (ChunkIndex == ChunkSizes.Num())
+		{
+			ChunkSizes.Add(0);
+			OutChunks.AddDefaulted();
+		}
+
+		ChunkSizes[ChunkIndex] += ItemSize;
+		OutChunks[ChunkIndex].Add(ItemIndex);
+	}
+
+	for (auto& Chunk : OutChunks)
+	{
+		Chunk.Sort();
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakChunkingTest, "ExportPak.BatchChunking", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakChunkingTest::RunTest(const FString& Parameters)
+{
+	const int64 MaxChunkSize = 100;
+
+	TArray<int64> ItemSizes = { 60, 10, 250, 40, 30, 70, 0, 100, 20 };
+	TArray<TArray<int32>> Chunks;
+	PackIntoChunks(ItemSizes, MaxChunkSize, Chunks);
+
+	TArray<int32> ItemChunks;
+	ItemChunks.Init(INDEX_NONE, ItemSizes.Num());
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		int64 ChunkSize = 0;
+		for (const int32 ItemIndex : Chunks[ChunkIndex])
+		{
+			TestEqual(TEXT("Every item is in one chunk only"), ItemChunks[ItemIndex], (int32)INDEX_NONE);
+			ItemChunks[ItemIndex] = ChunkIndex;
+			ChunkSize += ItemSizes[ItemIndex];
+		}
+
+		TestTrue(TEXT("Chunk under the cap, or a single oversized item"), ChunkSize <= MaxChunkSize || Chunks[ChunkIndex].Num() == 1);
+	}
+
+	TestFalse(TEXT("Every item is in a chunk"), ItemChunks.Contains(INDEX_NONE));
+
+	// The 250 needs its own chunk and the remaining 330 need at least 4 more, first-fit decreasing finds that.
+	TestEqual(TEXT("Chunks"), Chunks.Num(), 5);
+
+	TArray<TArray<int32>> SingleChunk;
+	PackIntoChunks(ItemSizes, 0, SingleChunk);
+	TestEqual(TEXT("No cap means one chunk"), SingleChunk.Num(), 1);
+
+	return true;
+}
+
+/** Sum of the known sizes of the files. */
+int64 GetTotalSize(const TArray<FExportPakFileEntry>& Files)
+{
+	int64 TotalSize = 0;
+	for (const auto& File : Files)
+	{
+		TotalSize += FMath::Max<int64>(File.Size, 0);
+	}
+	return TotalSize;
+}
+
+/** Find the cooked files of a package for a platform and where they are mounted inside a pak. A package that was not cooked adds none. */
+void GatherCookedFilesOfPackage(const FString& PackageNameInGameDir, const FExportPakPlatform& Platform, FExportPakStats& Stats, TArray<FExportPakFileEntry>& OutFiles)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExportPak_CookedFileDiscovery);
+	FExportPakScopedStageTimer StageTimer(Stats, EExportPakStage::CookedFileDiscovery);
+
+	UE_LOG(LogExportPak, Log, TEXT("        %s"), *PackageNameInGameDir);
+
+	const TArray<FExportPakCookedFile>* CookedFiles = Platform.CookedIndex->FindFiles(PackageNameInGameDir);
+	if (CookedFiles == nullptr)
+	{
+		// Same as before the index existed: a package that was not cooked just adds no file.
+		UE_LOG(LogExportPak, Warning, TEXT("        %s has no cooked file for %s."), *PackageNameInGameDir, *Platform.CookedPlatformName);
+		return;
+	}
+
+	FString ProjectName = FPaths::GetBaseFilename(FPaths::GetProjectFilePath());
+	for (const auto& CookedFile : *CookedFiles)
+	{
+		FString RelativePathForResponseFile = FPaths::Combine(TEXT("../../.."), ProjectName, CookedFile.RelativePath);
+
+		OutFiles.Add(FExportPakFileEntry(CookedFile.Filepath, RelativePathForResponseFile, CookedFile.Size));
+		StageTimer.AddFiles(1, CookedFile.Size);
+	}
+}
+
+FString GetUnrealPakExeFilepath()
+{
+	// UnrealPak runs on the editor host, whatever the target platform is.
+#if PLATFORM_WINDOWS
+	FString UnrealPakExeFilepath = FPaths::Combine(FPaths::EngineDir(), TEXT("Binaries/Win64/UnrealPak.exe"));
+#elif PLATFORM_MAC
+	FString UnrealPakExeFilepath = FPaths::Combine(FPaths::EngineDir(), TEXT("Binaries/Mac/UnrealPak"));
+#else
+	FString UnrealPakExeFilepath = FPaths::Combine(FPaths::EngineDir(), TEXT("Binaries/Linux/UnrealPak"));
+#endif
+	FPaths::MakeStandardFilename(UnrealPakExeFilepath);
+	return FPaths::ConvertRelativePathToFull(UnrealPakExeFilepath);
+}
+
+/** Everything that affects the pak content apart from the input files and their compression. */
+FString GetUnrealPakOptions(const FExportPakPlatform& Platform, int32 CompressionBlockSize)
+{
+	return FString::Printf(TEXT("-encryptionini -platform=%s -installed -UTF8Output -multiprocess -patchpaddingalign=2048 -compressionblocksize=%d"), *Platform.IniPlatformName, CompressionBlockSize);
+}
+
+ECompressionFlags GetCompressionFlags(EExportPakCompressionFormat Format)
+{
+	switch (Format)
+	{
+	case EExportPakCompressionFormat::Zlib:
+		return COMPRESS_ZLIB;
+	default:
+		return COMPRESS_None;
+	}
+}
+
+/** Set the CompressionMethod of every file, files under the size threshold of the profile stay raw. */
+void ApplyCompressionProfile(const FExportPakCompressionProfile& Profile, TArray<FExportPakFileEntry>& Files)
+{
+	const ECompressionFlags CompressionFlags = GetCompressionFlags(Profile.Format);
+	for (auto& File : Files)
+	{
+		File.CompressionMethod = File.Size >= Profile.MinSizeToCompressInBytes ? CompressionFlags : COMPRESS_None;
+	}
+}
+
+/**
+ * Which files are compressed is not part of the options, so the export cache keys on this as well.
+ * Hashed directly, the name hash cache is only meant for package names.
+ */
+FString GetCompressionCacheKey(const TArray<FExportPakFileEntry>& Files)
+{
+	FString CompressionMethods;
+	for (const auto& File : Files)
+	{
+		CompressionMethods.AppendInt(File.CompressionMethod);
+	}
+
+	FTCHARToUTF8 CompressionMethodsUtf8(*CompressionMethods);
+	FSHAHash CompressionMethodsHash;
+	FSHA1::HashBuffer(CompressionMethodsUtf8.Get(), CompressionMethodsUtf8.Length(), CompressionMethodsHash.Hash);
+
+	return TEXT(" -compressedfiles=") + CompressionMethodsHash.ToString();
+}
+
+/** Map the cooked platform names of the settings to target platforms. Fails on unknown names. */
+bool ResolvePlatforms(const TArray<FString>& CookedPlatformNames, TArray<FExportPakPlatform>& OutPlatforms)
+{
+	ITargetPlatformManagerModule& TargetPlatformManager = GetTargetPlatformManagerRef();
+
+	for (const auto& CookedPlatformName : CookedPlatformNames)
+	{
+		if (CookedPlatformName.IsEmpty() || OutPlatforms.ContainsByPredicate([&CookedPlatformName](const FExportPakPlatform& Platform) { return Platform.CookedPlatformName == CookedPlatformName; }))
+		{
+			continue;
+		}
+
+		const ITargetPlatform* TargetPlatform = TargetPlatformManager.FindTargetPlatform(CookedPlatformName);
+		if (TargetPlatform == nullptr)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Unknown target platform %s, expected a cooked platform name like WindowsNoEditor or LinuxNoEditor."), *CookedPlatformName);
+			return false;
+		}
+
+		FExportPakPlatform& Platform = OutPlatforms[OutPlatforms.AddDefaulted()];
+		Platform.CookedPlatformName = CookedPlatformName;
+		Platform.IniPlatformName = TargetPlatform->IniPlatformName();
+
+		if (!FPaths::DirectoryExists(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Cooked"), CookedPlatformName)))
+		{
+			UE_LOG(LogExportPak, Warning, TEXT("%s has not been cooked yet, its paks will be empty."), *CookedPlatformName);
+		}
+	}
+
+	if (OutPlatforms.Num() == 0)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("No target platform to export, fill TargetPlatforms in the settings."));
+		return false;
+	}
+
+	return true;
+}
+
+FExportPakProcessJob MakeUnrealPakJob(const FExportPakTask& Task, FExportPakStats& Stats)
+{
+	FString LogFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp"), Task.CookedPlatformName, Task.HashedName + ".log");
+	FString ResponseFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp"), Task.CookedPlatformName, Task.HashedName + "_Paklist.txt");
+
+	// A failure is logged, UnrealPak then fails on the missing file and the job reports it.
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExportPak_ResponseFile);
+		FExportPakScopedStageTimer StageTimer(Stats, EExportPakStage::ResponseFile);
+
+		FExportPakResponseFileWriter::Save(ResponseFilepath, Task.Files);
+		StageTimer.AddFiles(1, IFileManager::Get().FileSize(*ResponseFilepath));
+	}
+
+	FExportPakProcessJob Job;
+	Job.Name = Task.Name;
+	Job.ExecutableFilepath = GetUnrealPakExeFilepath();
+	Job.CommandLine = FString::Printf(
+		TEXT("%s -create=%s %s -abslog=%s"),
+		*Task.OutputPakFilepath,
+		*ResponseFilepath,
+		*Task.UnrealPakOptions,
+		*LogFilepath
+	);
+
+	// UnrealPak sorts the files of a response file, only an order file makes it keep the open order.
+	if (Task.NumFilesInOpenOrder > 0)
+	{
+		FString OrderFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp"), Task.CookedPlatformName, Task.HashedName + "_Order.txt");
+		if (FExportPakResponseFileWriter::SaveOrderFile(OrderFilepath, Task.Files))
+		{
+			Job.CommandLine += FString::Printf(TEXT(" -order=%s"), *OrderFilepath);
+		}
+	}
+
+	return Job;
+}
+
+void LogUnrealPakJobResult(const FExportPakProcessJob& Job)
+{
+	if (Job.bCancelled)
+	{
+		UE_LOG(LogExportPak, Log, TEXT("ExportPak cancelled: %s"), *Job.Name);
+	}
+	else if (!Job.bLaunched)
+	{
+		UE_LOG(LogExportPak, Error, TEXT(" Failed to launch unrealPak.exe: %s"), *Job.ExecutableFilepath);
+	}
+	else if (Job.ReturnCode == 0)
+	{
+		UE_LOG(LogExportPak, Log, TEXT("ExportPak success: %s\n%s"), *Job.Name, *Job.StdOut);
+	}
+	else
+	{
+		UE_LOG(LogExportPak, Warning, TEXT("ExportPak Falied: %s\nReturnCode=%d\n%s"), *Job.Name, Job.ReturnCode, *Job.StdOut);
+	}
+}
+
+void RunPakTasksWithUnrealPak(const TArray<FExportPakTask>& Tasks, int32 MaxConcurrentPakJobs, FExportPakStatus& Status, FExportPakStats& Stats, TArray<bool>& OutTaskSucceeded)
+{
+	FExportPakProcessPool ProcessPool(MaxConcurrentPakJobs);
+	for (const auto& Task : Tasks)
+	{
+		ProcessPool.AddJob(MakeUnrealPakJob(Task, Stats));
+	}
+
+	// Response files are all written, now keep the UnrealPak processes busy.
+	FExportPakProgress Progress(static_cast<float>(Tasks.Num()));
+	UE_LOG(LogExportPak, Log, TEXT("Running %d UnrealPak job(s), %d at a time."), Tasks.Num(), ProcessPool.GetMaxProcesses());
+
+	ProcessPool.Run(FOnExportPakProcessJobFinished::CreateLambda([&Progress, &Status](const FExportPakProcessJob& Job)
+	{
+		LogUnrealPakJobResult(Job);
+		Status.NumPaksFinished.Increment();
+		Progress.EnterProgressFrame(1.0f, FText::Format(NSLOCTEXT("ExportPak", "GenerateIndividualPakFiles", "Dependent asset {0}"), FText::FromString(Job.Name)));
+	}), &Status.bCancelRequested);
+
+	OutTaskSucceeded.SetNumZeroed(Tasks.Num());
+	for (int32 TaskIndex = 0; TaskIndex < Tasks.Num(); ++TaskIndex)
+	{
+		const FExportPakProcessJob& Job = ProcessPool.GetJobs()[TaskIndex];
+		OutTaskSucceeded[TaskIndex] = Job.bLaunched && !Job.bCancelled && Job.ReturnCode == 0;
+
+		if (Job.bLaunched)
+		{
+			Stats.Add(EExportPakStage::ProcessSpawn, Job.LaunchSeconds, 0, 0);
+			Stats.Add(EExportPakStage::UnrealPakProcess, Job.RunSeconds, Tasks[TaskIndex].Files.Num(), GetTotalSize(Tasks[TaskIndex].Files));
+		}
+	}
+}
+
+void RunPakTasksInProcess(const TArray<FExportPakTask>& Tasks, int32 MaxConcurrentPakJobs, FExportPakStatus& Status, FExportPakStats& Stats, TArray<bool>& OutTaskSucceeded)
+{
+	FExportPakProgress Progress(static_cast<float>(Tasks.Num()));
+	UE_LOG(LogExportPak, Log, TEXT("Writing %d pak file(s)."), Tasks.Num());
+
+	// Each worker only writes the slots of the tasks it picked.
+	OutTaskSucceeded.SetNumZeroed(Tasks.Num());
+
+	int32 NumReportedTasks = 0;
+	ExportPakParallelFor(Tasks.Num(), MaxConcurrentPakJobs, EAsyncExecution::ThreadPool,
+		[&Tasks, &Status, &Stats, &OutTaskSucceeded](int32 TaskIndex)
+		{
+			// Tasks not started yet are dropped, a pak that is being written is finished.
+			if (!Status.bCancelRequested)
+			{
+				SCOPE_CYCLE_COUNTER(STAT_ExportPak_PakWrite);
+				FExportPakScopedStageTimer StageTimer(Stats, EExportPakStage::PakWrite);
+
+				const FExportPakTask& Task = Tasks[TaskIndex];
+				FExportPakWriterOptions WriterOptions;
+				WriterOptions.CompressionBlockSize = Task.CompressionBlockSize;
+
+				FExportPakWriter Writer(Task.OutputPakFilepath, WriterOptions);
+				OutTaskSucceeded[TaskIndex] = Writer.Write(Task.Files);
+				StageTimer.AddFiles(Task.Files.Num(), IFileManager::Get().FileSize(*Task.OutputPakFilepath));
+				if (OutTaskSucceeded[TaskIndex])
+				{
+					UE_LOG(LogExportPak, Log, TEXT("ExportPak success: %s -> %s"), *Task.Name, *Task.OutputPakFilepath);
+				}
+			}
+			Status.NumPaksFinished.Increment();
+		},
+		[&Tasks, &Progress, &NumReportedTasks](int32 NumFinished)
+		{
+			Progress.EnterProgressFrame(static_cast<float>(NumFinished - NumReportedTasks), FText::Format(NSLOCTEXT("ExportPak", "WritePakFiles", "Written {0} of {1} pak file(s)"), FText::AsNumber(NumFinished), FText::AsNumber(Tasks.Num())));
+			NumReportedTasks = NumFinished;
+		});
+}
+
+/** Saved/ExportPak/Paks/<Platform>/<SHA1 of the root package>, holds the description file and the paks owned by that root. */
+FString GetRootPakOutputDirectory(const FString& HashedMainPackageName, const FExportPakPlatform& Platform)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Paks"), Platform.CookedPlatformName, HashedMainPackageName);
+}
+
+/** Saved/ExportPak/Paks/<Platform>/Shared, individual paks referenced by several roots are stored here only once. */
+FString GetSharedPakStoreDirectory(const FExportPakPlatform& Platform)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Paks"), Platform.CookedPlatformName, TEXT("Shared"));
+}
+
+/** Sizes of a pak from its index, so it works whoever wrote the pak. */
+FExportPakSizes ReadPakSizes(const FString& PakFilepath)
+{
+	FExportPakSizes Sizes;
+	if (IFileManager::Get().FileExists(*PakFilepath))
+	{
+		FPakFile PakFile(&FPlatformFileManager::Get().GetPlatformFile(), *PakFilepath, false);
+		if (PakFile.IsValid())
+		{
+			Sizes.CompressedSize = 0;
+			Sizes.RawSize = 0;
+			for (FPakFile::FFileIterator It(PakFile); It; ++It)
+			{
+				Sizes.CompressedSize += It.Info().Size;
+				Sizes.RawSize += It.Info().UncompressedSize;
+			}
+		}
+	}
+	Sizes.FileSize = FPlatformFileManager::Get().GetPlatformFile().FileSize(*PakFilepath);
+
+	return Sizes;
+}
+
+/**
+ * file_size_in_bytes, and the stored and uncompressed size of the entries of a pak, all as strings.
+ * With the Digest of a verified pak, also its SHA1 block digests.
+ */
+void WritePakSizeFields(FExportPakJsonWriter& JsonWriter, const FExportPakSizes& Sizes, const FExportPakDigest* Digest = nullptr)
+{
+	JsonWriter.WriteValue(TEXT("file_size_in_bytes"), FString::Printf(TEXT("%lld"), Sizes.FileSize));
+	JsonWriter.WriteValue(TEXT("compressed_size_in_bytes"), FString::Printf(TEXT("%lld"), Sizes.CompressedSize));
+	JsonWriter.WriteValue(TEXT("raw_size_in_bytes"), FString::Printf(TEXT("%lld"), Sizes.RawSize));
+
+	if (Digest != nullptr)
+	{
+		JsonWriter.WriteValue(TEXT("sha1_of_blocks"), Digest->HashOfBlocks.ToString());
+		JsonWriter.WriteValue(TEXT("sha1_block_size_in_bytes"), FString::Printf(TEXT("%lld"), Digest->BlockSize));
+		JsonWriter.WriteArrayStart(TEXT("sha1_blocks"));
+		for (const auto& BlockHash : Digest->BlockHashes)
+		{
+			JsonWriter.WriteValue(BlockHash.ToString());
+		}
+		JsonWriter.WriteArrayEnd();
+	}
+}
+
+/** cooked_files: every cooked file of the closure of a root, what a later patch export diffs against. */
+void WriteCookedFilesField(FExportPakJsonWriter& JsonWriter, const TArray<FExportPakCookedFileRecord>& CookedFiles)
+{
+	JsonWriter.WriteArrayStart(TEXT("cooked_files"));
+	for (const auto& CookedFile : CookedFiles)
+	{
+		JsonWriter.WriteObjectStart();
+		JsonWriter.WriteValue(TEXT("path"), CookedFile.DestFilepath);
+		JsonWriter.WriteValue(TEXT("size"), FString::Printf(TEXT("%lld"), CookedFile.Size));
+		JsonWriter.WriteValue(TEXT("sha1"), CookedFile.Hash);
+		JsonWriter.WriteObjectEnd();
+	}
+	JsonWriter.WriteArrayEnd();
+}
+
+/** A named array of the DestFilepaths of some of the cooked files. */
+void WriteCookedFilePaths(FExportPakJsonWriter& JsonWriter, const TCHAR* FieldName, const TArray<FExportPakCookedFileRecord>& CookedFiles, const TArray<int32>& FileIndices)
+{
+	JsonWriter.WriteArrayStart(FieldName);
+	for (const int32 FileIndex : FileIndices)
+	{
+		JsonWriter.WriteValue(CookedFiles[FileIndex].DestFilepath);
+	}
+	JsonWriter.WriteArrayEnd();
+}
+
+FExportPakExporter::FExportPakExporter(const UExportPakSettings* InSettings)
+	:
+	Settings(InSettings),
+	NextRootIndex(0),
+	RootQueue(2 * FMath::Max(InSettings->MaxConcurrentRoots, 1)),
+	CreationTime(FPlatformTime::Seconds())
+{
+}
+
+FExportPakExporter::~FExportPakExporter()
+{
+}
+
+FString FExportPakExporter::GetExportStatsFilepath()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak"), TEXT("ExportStats.json")));
+}
+
+FExportPakStats& FExportPakExporter::GetRootStats(const FString& RootPackage)
+{
+	FScopeLock RootStatsLock(&RootStatsCritical);
+
+	TSharedPtr<FExportPakStats>& Stats = RootStats.FindOrAdd(RootPackage);
+	if (!Stats.IsValid())
+	{
+		Stats = MakeShareable(new FExportPakStats);
+	}
+
+	return *Stats;
+}
+
+bool FExportPakExporter::SaveExportStats()
+{
+	FScopeLock RootStatsLock(&RootStatsCritical);
+
+	FExportPakStats TotalStats;
+	TotalStats.Append(GlobalStats);
+
+	TSharedPtr<FJsonObject> RootsJsonObject = MakeShareable(new FJsonObject);
+	for (const auto& RootStatsEntry : RootStats)
+	{
+		TotalStats.Append(*RootStatsEntry.Value);
+
+		TSharedPtr<FJsonObject> RootJsonObject = MakeShareable(new FJsonObject);
+		const double* WallSeconds = RootWallSeconds.Find(RootStatsEntry.Key);
+		RootJsonObject->SetNumberField("wall_seconds", WallSeconds ? *WallSeconds : 0.0);
+		RootJsonObject->SetObjectField("stages", RootStatsEntry.Value->ToJson());
+
+		RootsJsonObject->SetObjectField(RootStatsEntry.Key, RootJsonObject);
+	}
+
+	TSharedPtr<FJsonObject> StatsJsonObject = MakeShareable(new FJsonObject);
+	StatsJsonObject->SetNumberField("wall_seconds", FPlatformTime::Seconds() - CreationTime);
+	StatsJsonObject->SetObjectField("stages", TotalStats.ToJson());
+	StatsJsonObject->SetObjectField("roots", RootsJsonObject);
+
+	FString OutputString;
+	auto JsonWirter = TJsonWriterFactory<>::Create(&OutputString);
+	FJsonSerializer::Serialize(StatsJsonObject.ToSharedRef(), JsonWirter);
+
+	FString ResultFileFilename = GetExportStatsFilepath();
+	bool bSaveSuccess = FFileHelper::SaveStringToFile(OutputString, *ResultFileFilename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	if (!bSaveSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to export %s"), *ResultFileFilename);
+	}
+
+	for (int32 StageIndex = 0; StageIndex < (int32)EExportPakStage::Num; ++StageIndex)
+	{
+		const FExportPakStageStats StageStats = TotalStats.GetStage((EExportPakStage)StageIndex);
+		if (StageStats.Calls > 0)
+		{
+			UE_LOG(LogExportPak, Display, TEXT("%-24s %8.3f s %8lld call(s) %8lld file(s) %12lld byte(s)"), FExportPakStats::GetStageName((EExportPakStage)StageIndex), StageStats.Seconds, StageStats.Calls, StageStats.Files, StageStats.Bytes);
+		}
+	}
+
+	return bSaveSuccess;
+}
+
+FString FExportPakExporter::GetDependenciesInfoFilepath()
+{
+	FString ResultFileFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak"), TEXT("/AssetDependencies.json"));
+	return FPaths::ConvertRelativePathToFull(ResultFileFilename);
+}
+
+FString FExportPakExporter::GetDependenciesManifestFilepath()
+{
+	return FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak"), TEXT("AssetDependencies.bin")));
+}
+
+bool FExportPakExporter::UseSharedPakStore() const
+{
+	return Settings->bUseSharedPakStore && !Settings->bUseBatchMode;
+}
+
+EExportPakNameHash FExportPakExporter::GetNameHash() const
+{
+	return Settings->bLegacyPackageNameHashes ? EExportPakNameHash::LegacyAnsi : EExportPakNameHash::Utf8;
+}
+
+FString FExportPakExporter::HashPackageName(const FString& PackageName) const
+{
+	return HashStringWithSHA1(PackageName, GetNameHash());
+}
+
+bool FExportPakExporter::NeedsPackageAssetClasses() const
+{
+	if (Settings->ClassCompressionProfiles.Num() > 0)
+	{
+		return true;
+	}
+
+	return Settings->GroupingRules.ContainsByPredicate([](const FExportPakGroupingRule& Rule)
+	{
+		return Rule.AssetClasses.Num() > 0;
+	});
+}
+
+FString FExportPakExporter::GetPackageAssetClass(const FString& PackageName)
+{
+	FScopeLock PackageAssetClassesLock(&PackageAssetClassesCritical);
+	if (const FString* AssetClass = PackageAssetClasses.Find(PackageName))
+	{
+		return *AssetClass;
+	}
+	return FString();
+}
+
+const FExportPakCompressionProfile& FExportPakExporter::GetCompressionProfile(const FString& PackageName)
+{
+	const FString AssetClass = GetPackageAssetClass(PackageName);
+
+	for (const auto& ClassCompressionProfile : Settings->ClassCompressionProfiles)
+	{
+		if (!AssetClass.IsEmpty() && ClassCompressionProfile.AssetClass == AssetClass)
+		{
+			return ClassCompressionProfile.Profile;
+		}
+	}
+
+	return Settings->DefaultCompression;
+}
+
+bool FExportPakExporter::Export()
+{
+	// Without platforms the dependencies are still saved, there are just no paks.
+	const bool bPlatformsResolved = ResolveTargetPlatforms();
+
+	TFuture<bool> PakGeneration;
+	if (bPlatformsResolved)
+	{
+		PakGeneration = Async<bool>(EAsyncExecution::Thread, [this]()
+		{
+			return GeneratePakFilesOfQueuedRoots();
+		});
+	}
+
+	// A root is queued as soon as it is walked, so its paks are written while the next roots are walked.
+	TMap<FString, FDependenciesInfo> DependenciesInfos;
+	BeginDependencyWalk();
+
+	FExportPakWalkedRoot WalkedRoot;
+	while (!Status.bCancelRequested && WalkNextRoot(WalkedRoot))
+	{
+		if (bPlatformsResolved)
+		{
+			QueueRoot(WalkedRoot);
+		}
+		DependenciesInfos.Add(WalkedRoot.RootPackage, MoveTemp(WalkedRoot.DependenciesInfo));
+	}
+	CloseRootQueue();
+
+	// Saved while the last roots are still being packed.
+	bool bSuccess = SaveDependenciesInfo(DependenciesInfos);
+
+	bSuccess &= bPlatformsResolved && PakGeneration.Get();
+
+	return bSuccess;
+}
+
+/**
+ * Assets of all the packages from one asset registry query, instead of one query per package.
+ * Only what the registry has gathered from disk is looked at: cooked content comes from saved packages, and
+ * including in-memory assets would walk every loaded object. Packages the registry does not know are not in the result.
+ */
+void GetAssetsOfPackages(IAssetRegistry& AssetRegistry, const TArray<FName>& PackageNames, TMap<FName, TArray<FAssetData>>& OutAssets)
+{
+	// An empty filter would return every asset.
+	if (PackageNames.Num() == 0)
+	{
+		return;
+	}
+
+	FARFilter Filter;
+	Filter.PackageNames = PackageNames;
+	Filter.bIncludeOnlyOnDiskAssets = true;
+
+	TArray<FAssetData> AssetDataList;
+	AssetRegistry.GetAssets(Filter, AssetDataList);
+
+	for (auto& AssetData : AssetDataList)
+	{
+		OutAssets.FindOrAdd(AssetData.PackageName).Add(AssetData);
+	}
+}
+
+void FExportPakExporter::GetAssetDependecies(TMap<FString, FDependenciesInfo>& DependenciesInfos)
+{
+	BeginDependencyWalk();
+
+	FExportPakWalkedRoot WalkedRoot;
+	while (WalkNextRoot(WalkedRoot))
+	{
+		DependenciesInfos.Add(WalkedRoot.RootPackage, MoveTemp(WalkedRoot.DependenciesInfo));
+	}
+}
+
+void FExportPakExporter::BeginDependencyWalk()
+{
+	check(IsInGameThread());
+
+	FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
+	IAssetRegistry& AssetRegistry = AssetRegistryModule.Get();
+
+	if (AssetRegistry.IsLoadingAssets())
+	{
+		UE_LOG(LogExportPak, Warning, TEXT("The asset registry is still discovering assets, roots it has not seen yet are skipped."));
+	}
+
+	// Shared by all roots, so common dependencies are only queried and walked once per export.
+	DependencyWalker.Reset(new FExportPakDependencyWalker([&AssetRegistry](const FName& PackageName, TArray<FName>& OutDependencies)
+	{
+		AssetRegistry.GetDependencies(PackageName, OutDependencies, EAssetRegistryDependencyType::Packages);
+	}));
+
+	RootPackageNames.Reset();
+	for (auto &PackageFilePath : Settings->PackagesToExport)
+	{
+		FStringAssetReference AssetRef = PackageFilePath.FilePath;
+		FString TargetLongPackageName = AssetRef.GetLongPackageName();
+		if (!TargetLongPackageName.IsEmpty())
+		{
+			RootPackageNames.AddUnique(FName(*TargetLongPackageName));
+		}
+	}
+
+	// A root exists if the registry knows an asset in it, which saves a disk hit per root.
+	TMap<FName, TArray<FAssetData>> RootAssets;
+	GetAssetsOfPackages(AssetRegistry, RootPackageNames, RootAssets);
+
+	RootAssetClasses.Reset();
+	for (const auto& RootAssetsEntry : RootAssets)
+	{
+		if (RootAssetsEntry.Value.Num() > 1)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Got multiple AssetData of  %s, please check."), *RootAssetsEntry.Key.ToString());
+		}
+		RootAssetClasses.Add(RootAssetsEntry.Key, RootAssetsEntry.Value[0].AssetClass.ToString());
+	}
+
+	NextRootIndex = 0;
+	Status.NumRoots.Set(RootAssetClasses.Num());
+}
+
+bool FExportPakExporter::WalkNextRoot(FExportPakWalkedRoot& OutRoot)
+{
+	check(IsInGameThread() && DependencyWalker.IsValid());
+
+	while (NextRootIndex < RootPackageNames.Num())
+	{
+		const FName RootPackageName = RootPackageNames[NextRootIndex++];
+		FString TargetLongPackageName = RootPackageName.ToString();
+
+		const FString* AssetClass = RootAssetClasses.Find(RootPackageName);
+		if (AssetClass == nullptr)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Failed to get AssetData of  %s, please check."), *TargetLongPackageName);
+			continue;
+		}
+
+		OutRoot.RootPackage = TargetLongPackageName;
+		OutRoot.DependenciesInfo = FDependenciesInfo();
+		OutRoot.DependenciesInfo.AssetClassString = *AssetClass;
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_ExportPak_DependencyWalk);
+			FExportPakScopedStageTimer StageTimer(GetRootStats(TargetLongPackageName), EExportPakStage::DependencyWalk);
+
+			DependencyWalker->GatherDependencies(RootPackageName, OutRoot.DependenciesInfo.DependenciesInGameContentDir, OutRoot.DependenciesInfo.OtherDependencies);
+			StageTimer.AddFiles(OutRoot.DependenciesInfo.DependenciesInGameContentDir.Num() + OutRoot.DependenciesInfo.OtherDependencies.Num(), 0);
+		}
+
+		// The asset registry is game thread only, so the classes the compression profiles and grouping rules need
+		// are looked up now, in one query for the packages of this root not seen before.
+		if (NeedsPackageAssetClasses())
+		{
+			TArray<FName> NewPackageNames;
+			{
+				FScopeLock PackageAssetClassesLock(&PackageAssetClassesCritical);
+				PackageAssetClasses.Add(TargetLongPackageName, *AssetClass);
+				for (const auto& Dependency : OutRoot.DependenciesInfo.DependenciesInGameContentDir)
+				{
+					if (!PackageAssetClasses.Contains(Dependency))
+					{
+						NewPackageNames.Add(FName(*Dependency));
+					}
+				}
+			}
+
+			TMap<FName, TArray<FAssetData>> DependencyAssets;
+			GetAssetsOfPackages(FModuleManager::GetModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get(), NewPackageNames, DependencyAssets);
+
+			FScopeLock PackageAssetClassesLock(&PackageAssetClassesCritical);
+			for (const auto& DependencyAssetsEntry : DependencyAssets)
+			{
+				PackageAssetClasses.Add(DependencyAssetsEntry.Key.ToString(), DependencyAssetsEntry.Value[0].AssetClass.ToString());
+			}
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+bool FExportPakExporter::RunPakTasks(const TArray<FExportPakTask>& Tasks, FExportPakCache& ExportCache, FExportPakStats& Stats, TArray<bool>& OutTaskSucceeded)
+{
+	const FString CacheOptionsPrefix = Settings->bUseUnrealPak ? TEXT("UnrealPak ") : TEXT("InProcess ");
+	Status.NumPaks.Add(Tasks.Num());
+
+	TArray<FExportPakTask> OutdatedTasks;
+	TArray<int32> OutdatedTaskIndices;
+	// Index in OutdatedTasks of each task, INDEX_NONE if it is up to date.
+	TArray<int32> TaskOutdatedIndices;
+	TaskOutdatedIndices.Init(INDEX_NONE, Tasks.Num());
+	for (int32 TaskIndex = 0; TaskIndex < Tasks.Num(); ++TaskIndex)
+	{
+		const FExportPakTask& Task = Tasks[TaskIndex];
+		bool bUpToDate = false;
+		if (Settings->bSkipUnchangedPaks)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_ExportPak_CacheCheck);
+			FExportPakScopedStageTimer StageTimer(Stats, EExportPakStage::CacheCheck);
+
+			bUpToDate = ExportCache.IsUpToDate(Task.OutputPakFilepath, Task.Files, CacheOptionsPrefix + Task.UnrealPakOptions + GetCompressionCacheKey(Task.Files));
+			StageTimer.AddFiles(Task.Files.Num(), GetTotalSize(Task.Files));
+		}
+
+		if (bUpToDate)
+		{
+			UE_LOG(LogExportPak, Log, TEXT("Skipping unchanged pak: %s -> %s"), *Task.Name, *Task.OutputPakFilepath);
+			Status.NumPaksFinished.Increment();
+		}
+		else
+		{
+			TaskOutdatedIndices[TaskIndex] = OutdatedTasks.Add(Task);
+			OutdatedTaskIndices.Add(TaskIndex);
+		}
+	}
+
+	TArray<bool> TaskSucceeded;
+	if (OutdatedTasks.Num() > 0)
+	{
+		if (Settings->bUseUnrealPak)
+		{
+			RunPakTasksWithUnrealPak(OutdatedTasks, Settings->MaxConcurrentPakJobs, Status, Stats, TaskSucceeded);
+		}
+		else
+		{
+			RunPakTasksInProcess(OutdatedTasks, Settings->MaxConcurrentPakJobs, Status, Stats, TaskSucceeded);
+		}
+	}
+
+	// Unchanged paks are verified as well, so every description file gets the digests of its paks.
+	TArray<bool> TaskVerified;
+	TaskVerified.Init(true, Tasks.Num());
+	if (Settings->bVerifyPaks && !Status.bCancelRequested)
+	{
+		TArray<int32> TasksToVerify;
+		for (int32 TaskIndex = 0; TaskIndex < Tasks.Num(); ++TaskIndex)
+		{
+			const int32 OutdatedIndex = TaskOutdatedIndices[TaskIndex];
+			if (OutdatedIndex == INDEX_NONE || TaskSucceeded[OutdatedIndex])
+			{
+				TasksToVerify.Add(TaskIndex);
+			}
+		}
+
+		ParallelFor(TasksToVerify.Num(), [this, &Tasks, &TasksToVerify, &TaskVerified, &Stats](int32 Index)
+		{
+			TaskVerified[TasksToVerify[Index]] = VerifyPak(Tasks[TasksToVerify[Index]], Stats);
+		});
+	}
+
+	OutTaskSucceeded = TaskVerified;
+	for (int32 OutdatedIndex = 0; OutdatedIndex < OutdatedTasks.Num(); ++OutdatedIndex)
+	{
+		const int32 TaskIndex = OutdatedTaskIndices[OutdatedIndex];
+		OutTaskSucceeded[TaskIndex] = TaskSucceeded[OutdatedIndex] && TaskVerified[TaskIndex];
+	}
+
+	// A pak that fails verification is not recorded, so the next export rebuilds it, unchanged or not.
+	if (Settings->bSkipUnchangedPaks)
+	{
+		for (int32 TaskIndex = 0; TaskIndex < Tasks.Num(); ++TaskIndex)
+		{
+			if (OutTaskSucceeded[TaskIndex])
+			{
+				ExportCache.Commit(Tasks[TaskIndex].OutputPakFilepath);
+			}
+			else
+			{
+				ExportCache.Discard(Tasks[TaskIndex].OutputPakFilepath);
+			}
+		}
+	}
+
+	return !OutTaskSucceeded.Contains(false);
+}
+
+bool FExportPakExporter::VerifyPak(const FExportPakTask& Task, FExportPakStats& Stats)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ExportPak_PakVerification);
+	FExportPakScopedStageTimer StageTimer(Stats, EExportPakStage::PakVerification);
+
+	FExportPakVerification Verification;
+	if (!FExportPakVerifier::CheckEntries(Task.OutputPakFilepath, Task.Files, Verification))
+	{
+		if (!Verification.bPakReadable)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Verification of %s failed, %s cannot be read."), *Task.Name, *Task.OutputPakFilepath);
+			return false;
+		}
+
+		UE_LOG(LogExportPak, Error, TEXT("Verification of %s failed: %d missing, %d unexpected and %d mismatched file(s) in %s."),
+			*Task.Name, Verification.MissingFiles.Num(), Verification.UnexpectedFiles.Num(), Verification.MismatchedFiles.Num(), *Task.OutputPakFilepath);
+		for (const auto& File : Verification.MissingFiles)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("    Missing: %s"), *File);
+		}
+		for (const auto& File : Verification.UnexpectedFiles)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("    Unexpected: %s"), *File);
+		}
+		for (const auto& File : Verification.MismatchedFiles)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("    Size differs from the cooked file: %s"), *File);
+		}
+		return false;
+	}
+
+	TSharedPtr<FExportPakDigest> Digest = MakeShareable(new FExportPakDigest);
+	if (!FExportPakVerifier::ComputeDigest(Task.OutputPakFilepath, (int64)Settings->DigestBlockSizeInKilobytes * 1024, *Digest))
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to hash %s"), *Task.OutputPakFilepath);
+		return false;
+	}
+	StageTimer.AddFiles(1, Digest->FileSize);
+
+	FScopeLock PakDigestsLock(&PakDigestsCritical);
+	PakDigests.Add(FPaths::ConvertRelativePathToFull(Task.OutputPakFilepath), Digest);
+
+	return true;
+}
+
+TSharedPtr<const FExportPakDigest> FExportPakExporter::FindPakDigest(const FString& PakFilepath)
+{
+	FScopeLock PakDigestsLock(&PakDigestsCritical);
+	if (const TSharedPtr<const FExportPakDigest>* Digest = PakDigests.Find(FPaths::ConvertRelativePathToFull(PakFilepath)))
+	{
+		return *Digest;
+	}
+	return nullptr;
+}
+
+FExportPakSizes FExportPakExporter::GetPakSizes(const FString& PakFilepath)
+{
+	const FString FullPakFilepath = FPaths::ConvertRelativePathToFull(PakFilepath);
+	{
+		FScopeLock PakSizesLock(&PakSizesCritical);
+		if (const FExportPakSizes* Sizes = PakSizes.Find(FullPakFilepath))
+		{
+			return *Sizes;
+		}
+	}
+
+	// Read outside of the lock. A pak that cannot be read is not remembered, it may still be written.
+	const FExportPakSizes Sizes = ReadPakSizes(FullPakFilepath);
+	if (Sizes.CompressedSize >= 0)
+	{
+		FScopeLock PakSizesLock(&PakSizesCritical);
+		PakSizes.Add(FullPakFilepath, Sizes);
+	}
+
+	return Sizes;
+}
+
+void FExportPakExporter::AddIndividualPakTasks(const TArray<FString>& PackagesToHandle, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks)
+{
+	FString PakOutputDirectory = UseSharedPakStore() ? GetSharedPakStoreDirectory(Platform) : GetRootPakOutputDirectory(HashPackageName(MainPackage), Platform);
+
+	for (auto& PackageNameInGameDir : PackagesToHandle)
+	{
+		// Another root writes the pak, GeneratePakFilesOfRoot() waits for it before describing the package.
+		const FString SharedPakKey = FExportPakSharedPakStore::MakeKey(Platform.CookedPlatformName, PackageNameInGameDir);
+		if (UseSharedPakStore() && !SharedPaks.Claim(SharedPakKey))
+		{
+			continue;
+		}
+
+		FExportPakTask& Task = OutTasks[OutTasks.AddDefaulted()];
+		GatherCookedFilesOfPackage(PackageNameInGameDir, Platform, Stats, Task.Files);
+
+		const FExportPakCompressionProfile& CompressionProfile = GetCompressionProfile(PackageNameInGameDir);
+		ApplyCompressionProfile(CompressionProfile, Task.Files);
+
+		Task.Name = PackageNameInGameDir;
+		Task.Packages.Add(PackageNameInGameDir);
+		Task.HashedName = HashPackageName(PackageNameInGameDir);
+		Task.OutputPakFilepath = FPaths::Combine(PakOutputDirectory, Task.HashedName + TEXT(".pak"));
+		Task.CookedPlatformName = Platform.CookedPlatformName;
+		Task.CompressionBlockSize = CompressionProfile.BlockSizeInKilobytes * 1024;
+		Task.UnrealPakOptions = GetUnrealPakOptions(Platform, Task.CompressionBlockSize);
+		Task.bSharedStorePak = UseSharedPakStore();
+	}
+}
+
+void FExportPakExporter::FinishSharedPaks(const TArray<FExportPakTask>& Tasks, const TArray<bool>& TaskSucceeded)
+{
+	for (int32 TaskIndex = 0; TaskIndex < Tasks.Num(); ++TaskIndex)
+	{
+		const FExportPakTask& Task = Tasks[TaskIndex];
+		if (Task.bSharedStorePak)
+		{
+			SharedPaks.Finish(FExportPakSharedPakStore::MakeKey(Task.CookedPlatformName, Task.Packages[0]), TaskSucceeded.IsValidIndex(TaskIndex) && TaskSucceeded[TaskIndex]);
+		}
+	}
+}
+
+void FExportPakExporter::AddBatchPakTask(const TArray<FString>& PackagesToHandle, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks)
+{
+	FString HashedMainPackageName = HashPackageName(MainPackage);
+	FString PakOutputDirectory = GetRootPakOutputDirectory(HashedMainPackageName, Platform);
+
+	// A package is the unit of chunking, so its .uasset, .uexp and .ubulk always end up in the same pak.
+	TArray<TArray<FExportPakFileEntry>> PackageFiles;
+	TArray<int64> PackageSizes;
+	PackageFiles.SetNum(PackagesToHandle.Num());
+	for (int32 PackageIndex = 0; PackageIndex < PackagesToHandle.Num(); ++PackageIndex)
+	{
+		GatherCookedFilesOfPackage(PackagesToHandle[PackageIndex], Platform, Stats, PackageFiles[PackageIndex]);
+		ApplyCompressionProfile(GetCompressionProfile(PackagesToHandle[PackageIndex]), PackageFiles[PackageIndex]);
+		PackageSizes.Add(GetTotalSize(PackageFiles[PackageIndex]));
+	}
+
+	TArray<TArray<int32>> Chunks;
+	PackIntoChunks(PackageSizes, (int64)Settings->MaxBatchPakSizeInMegabytes * 1024 * 1024, Chunks);
+
+	// A single chunk keeps the name batch paks always had.
+	for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		FExportPakTask& Task = OutTasks[OutTasks.AddDefaulted()];
+		Task.Name = Chunks.Num() > 1 ? FString::Printf(TEXT("%s [%d/%d]"), *MainPackage, ChunkIndex + 1, Chunks.Num()) : MainPackage;
+		Task.bBatchChunk = true;
+		Task.HashedName = Chunks.Num() > 1 ? FString::Printf(TEXT("%s_%d"), *HashedMainPackageName, ChunkIndex) : HashedMainPackageName;
+		Task.OutputPakFilepath = FPaths::Combine(PakOutputDirectory, Task.HashedName + TEXT(".pak"));
+		Task.CookedPlatformName = Platform.CookedPlatformName;
+		Task.CompressionBlockSize = Settings->DefaultCompression.BlockSizeInKilobytes * 1024;
+		Task.UnrealPakOptions = GetUnrealPakOptions(Platform, Task.CompressionBlockSize);
+
+		for (const int32 PackageIndex : Chunks[ChunkIndex])
+		{
+			Task.Packages.Add(PackagesToHandle[PackageIndex]);
+			Task.Files.Append(PackageFiles[PackageIndex]);
+		}
+	}
+
+	if (Chunks.Num() > 1)
+	{
+		UE_LOG(LogExportPak, Log, TEXT("Split the batch pak of %s into %d chunk(s)."), *MainPackage, Chunks.Num());
+	}
+}
+
+void FExportPakExporter::SplitPackagesByGroup(const TArray<FString>& PackagesToHandle, TArray<FString>& OutModePackages, TArray<FString>& OutOwnPakPackages, TMap<FString, TArray<FString>>& OutGroupPackages)
+{
+	if (Settings->GroupingRules.Num() == 0)
+	{
+		OutModePackages = PackagesToHandle;
+		return;
+	}
+
+	for (const auto& Package : PackagesToHandle)
+	{
+		const int32 RuleIndex = FindGroupingRule(Settings->GroupingRules, Package, GetPackageAssetClass(Package));
+		if (RuleIndex == INDEX_NONE)
+		{
+			OutModePackages.Add(Package);
+		}
+		else if (Settings->GroupingRules[RuleIndex].GroupName.IsEmpty())
+		{
+			OutOwnPakPackages.Add(Package);
+		}
+		else
+		{
+			OutGroupPackages.FindOrAdd(Settings->GroupingRules[RuleIndex].GroupName).Add(Package);
+		}
+	}
+}
+
+void FExportPakExporter::AddGroupPakTask(const FString& GroupName, const TArray<FString>& GroupPackages, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks)
+{
+	FString HashedMainPackageName = HashPackageName(MainPackage);
+
+	FExportPakTask& Task = OutTasks[OutTasks.AddDefaulted()];
+	for (const auto& Package : GroupPackages)
+	{
+		TArray<FExportPakFileEntry> PackageFiles;
+		GatherCookedFilesOfPackage(Package, Platform, Stats, PackageFiles);
+		ApplyCompressionProfile(GetCompressionProfile(Package), PackageFiles);
+		Task.Files.Append(PackageFiles);
+	}
+
+	// Group paks hold packages of this root only, so they live next to its description file.
+	Task.Name = FString::Printf(TEXT("%s [%s]"), *MainPackage, *GroupName);
+	Task.HashedName = HashedMainPackageName + TEXT("_") + FPaths::MakeValidFileName(GroupName, TEXT('_'));
+	Task.OutputPakFilepath = FPaths::Combine(GetRootPakOutputDirectory(HashedMainPackageName, Platform), Task.HashedName + TEXT(".pak"));
+	Task.CookedPlatformName = Platform.CookedPlatformName;
+	Task.CompressionBlockSize = Settings->DefaultCompression.BlockSizeInKilobytes * 1024;
+	Task.UnrealPakOptions = GetUnrealPakOptions(Platform, Task.CompressionBlockSize);
+	Task.Packages = GroupPackages;
+	Task.GroupName = GroupName;
+}
+
+void FExportPakExporter::ApplyFileOpenOrder(TArray<FExportPakTask>& Tasks) const
+{
+	for (auto& Task : Tasks)
+	{
+		Task.SeeksBeforeOpenOrder = FileOpenOrder->CountSeeks(Task.Files);
+		Task.NumFilesInOpenOrder = FileOpenOrder->Sort(Task.Files);
+		Task.SeeksInOpenOrder = FileOpenOrder->CountSeeks(Task.Files);
+
+		if (Task.NumFilesInOpenOrder > 0)
+		{
+			UE_LOG(LogExportPak, Log, TEXT("Laid out %d of %d file(s) of %s in open order, expected seeks %d -> %d."),
+				Task.NumFilesInOpenOrder, Task.Files.Num(), *Task.Name, Task.SeeksBeforeOpenOrder, Task.SeeksInOpenOrder);
+		}
+	}
+}
+
+bool FExportPakExporter::AddPatchPakTask(const TArray<FString>& PackagesToHandle, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakCache& ExportCache, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks, TArray<FExportPakCookedFileRecord>& OutCookedFiles, FExportPakPatchDiff& OutDiff)
+{
+	TArray<FExportPakFileEntry> Files;
+	if (!GatherCookedFilesOfRoot(PackagesToHandle, Platform, ExportCache, Stats, Files, OutCookedFiles))
+	{
+		return false;
+	}
+
+	FString HashedMainPackageName = HashPackageName(MainPackage);
+	FString BaselineFilepath = FExportPakPatch::GetBaselineDescriptionFilepath(Settings->PatchBaselineDirectory.Path, Platform.CookedPlatformName, HashedMainPackageName);
+
+	TMap<FString, FString> BaselineHashes;
+	if (!IFileManager::Get().FileExists(*BaselineFilepath))
+	{
+		// A root the baseline did not ship, all of its closure is new.
+		UE_LOG(LogExportPak, Warning, TEXT("No baseline description file %s, the patch of %s holds all of its cooked files."), *BaselineFilepath, *MainPackage);
+	}
+	else if (!FExportPakPatch::LoadBaselineCookedFiles(BaselineFilepath, BaselineHashes))
+	{
+		return false;
+	}
+
+	FExportPakPatch::Diff(BaselineHashes, OutCookedFiles, OutDiff);
+
+	FString PakFilepath = FPaths::Combine(GetRootPakOutputDirectory(HashedMainPackageName, Platform), HashedMainPackageName + TEXT("_P.pak"));
+
+	TArray<int32> FileIndices = OutDiff.ChangedFiles;
+	FileIndices.Append(OutDiff.AddedFiles);
+	if (FileIndices.Num() == 0)
+	{
+		// Nothing to mount, a patch pak left by an earlier patch export would be stale.
+		IFileManager::Get().Delete(*PakFilepath, false, false, true);
+		return true;
+	}
+
+	// The _P suffix makes the pak loader mount it over the baseline paks.
+	FExportPakTask& Task = OutTasks[OutTasks.AddDefaulted()];
+	Task.Name = MainPackage + TEXT(" [patch]");
+	Task.HashedName = HashedMainPackageName + TEXT("_P");
+	Task.OutputPakFilepath = PakFilepath;
+	Task.CookedPlatformName = Platform.CookedPlatformName;
+	Task.CompressionBlockSize = Settings->DefaultCompression.BlockSizeInKilobytes * 1024;
+	Task.UnrealPakOptions = GetUnrealPakOptions(Platform, Task.CompressionBlockSize);
+
+	FileIndices.Sort();
+	for (const int32 FileIndex : FileIndices)
+	{
+		Task.Files.Add(Files[FileIndex]);
+	}
+
+	UE_LOG(LogExportPak, Log, TEXT("Patch of %s for %s: %d changed, %d added, %d deleted file(s)."), *MainPackage, *Platform.CookedPlatformName, OutDiff.ChangedFiles.Num(), OutDiff.AddedFiles.Num(), OutDiff.DeletedFiles.Num());
+
+	return true;
+}
+
+bool FExportPakExporter::GatherCookedFilesOfRoot(const TArray<FString>& PackagesToHandle, const FExportPakPlatform& Platform, FExportPakCache& ExportCache, FExportPakStats& Stats, TArray<FExportPakFileEntry>& OutFiles, TArray<FExportPakCookedFileRecord>& OutCookedFiles)
+{
+	for (const auto& Package : PackagesToHandle)
+	{
+		TArray<FExportPakFileEntry> PackageFiles;
+		GatherCookedFilesOfPackage(Package, Platform, Stats, PackageFiles);
+		ApplyCompressionProfile(GetCompressionProfile(Package), PackageFiles);
+		OutFiles.Append(PackageFiles);
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_ExportPak_CookedFileHash);
+	FExportPakScopedStageTimer StageTimer(Stats, EExportPakStage::CookedFileHash);
+
+	OutCookedFiles.SetNum(OutFiles.Num());
+	// Files untouched since they were last hashed, by this export or a recorded one, are not read again.
+	ParallelFor(OutFiles.Num(), [&ExportCache, &OutFiles, &OutCookedFiles](int32 FileIndex)
+	{
+		FExportPakCookedFileRecord& CookedFile = OutCookedFiles[FileIndex];
+		CookedFile.DestFilepath = OutFiles[FileIndex].DestFilepath;
+		CookedFile.Size = OutFiles[FileIndex].Size;
+		CookedFile.Hash = ExportCache.HashInput(OutFiles[FileIndex]);
+	});
+	StageTimer.AddFiles(OutFiles.Num(), GetTotalSize(OutFiles));
+
+	for (int32 FileIndex = 0; FileIndex < OutFiles.Num(); ++FileIndex)
+	{
+		if (OutCookedFiles[FileIndex].Hash.IsEmpty())
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Failed to hash cooked file %s"), *OutFiles[FileIndex].SourceFilepath);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FExportPakExporter::GeneratePakFilesOfRoot(const FString& TargetPackage, const FDependenciesInfo& DependecyInfo, FExportPakCache& ExportCache)
+{
+	TArray<FString> PackagesToHandle = DependecyInfo.DependenciesInGameContentDir;
+	PackagesToHandle.Add(TargetPackage);
+
+	if (Status.bCancelRequested)
+	{
+		return false;
+	}
+
+	FExportPakStats& Stats = GetRootStats(TargetPackage);
+	const double StartTime = FPlatformTime::Seconds();
+
+	// The dependencies are walked once, every platform reuses them and all pak jobs share one pool.
+	bool bSuccess = true;
+	TArray<FExportPakTask> Tasks;
+	TArray<TArray<FExportPakCookedFileRecord>> PlatformCookedFiles;
+	TArray<FExportPakPatchDiff> PlatformPatchDiffs;
+	PlatformCookedFiles.SetNum(Platforms.Num());
+	PlatformPatchDiffs.SetNum(Platforms.Num());
+	for (int32 PlatformIndex = 0; PlatformIndex < Platforms.Num(); ++PlatformIndex)
+	{
+		const FExportPakPlatform& Platform = Platforms[PlatformIndex];
+		if (Settings->bExportPatch)
+		{
+			bSuccess &= AddPatchPakTask(PackagesToHandle, TargetPackage, Platform, ExportCache, Stats, Tasks, PlatformCookedFiles[PlatformIndex], PlatformPatchDiffs[PlatformIndex]);
+			continue;
+		}
+
+		// Packages a grouping rule takes leave the paks of the mode.
+		TArray<FString> ModePackages;
+		TArray<FString> OwnPakPackages;
+		TMap<FString, TArray<FString>> GroupPackages;
+		SplitPackagesByGroup(PackagesToHandle, ModePackages, OwnPakPackages, GroupPackages);
+
+		if (Settings->bUseBatchMode)
+		{
+			if (ModePackages.Num() > 0)
+			{
+				AddBatchPakTask(ModePackages, TargetPackage, Platform, Stats, Tasks);
+			}
+		}
+		else
+		{
+			AddIndividualPakTasks(ModePackages, TargetPackage, Platform, Stats, Tasks);
+		}
+
+		AddIndividualPakTasks(OwnPakPackages, TargetPackage, Platform, Stats, Tasks);
+		for (const auto& Group : GroupPackages)
+		{
+			AddGroupPakTask(Group.Key, Group.Value, TargetPackage, Platform, Stats, Tasks);
+		}
+
+		if (Settings->bRecordCookedFileHashes)
+		{
+			TArray<FExportPakFileEntry> RootFiles;
+			bSuccess &= GatherCookedFilesOfRoot(PackagesToHandle, Platform, ExportCache, Stats, RootFiles, PlatformCookedFiles[PlatformIndex]);
+		}
+	}
+
+	// A patch description made from a partial diff would tell the game to delete or keep the wrong files.
+	if (Settings->bExportPatch && !bSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to diff %s against the baseline, no patch is written."), *TargetPackage);
+		return false;
+	}
+
+	if (FileOpenOrder.IsValid())
+	{
+		ApplyFileOpenOrder(Tasks);
+	}
+
+	TArray<bool> TaskSucceeded;
+	bSuccess &= RunPakTasks(Tasks, ExportCache, Stats, TaskSucceeded);
+	FinishSharedPaks(Tasks, TaskSucceeded);
+
+	// A cancelled root has no complete set of paks, do not describe it.
+	if (Status.bCancelRequested)
+	{
+		return false;
+	}
+
+	// Shared paks other roots claimed may still be written, or may have failed.
+	if (UseSharedPakStore() && !Settings->bExportPatch)
+	{
+		TArray<FString> SharedPakKeys;
+		for (const auto& Platform : Platforms)
+		{
+			for (const auto& Package : PackagesToHandle)
+			{
+				SharedPakKeys.Add(FExportPakSharedPakStore::MakeKey(Platform.CookedPlatformName, Package));
+			}
+		}
+
+		if (!SharedPaks.Wait(SharedPakKeys, Status.bCancelRequested))
+		{
+			UE_LOG(LogExportPak, Error, TEXT("%s is not described, a pak it needs was not written."), *TargetPackage);
+			return false;
+		}
+	}
+
+	for (int32 PlatformIndex = 0; PlatformIndex < Platforms.Num(); ++PlatformIndex)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExportPak_DescriptionFile);
+		FExportPakScopedStageTimer StageTimer(Stats, EExportPakStage::DescriptionFile);
+
+		if (Settings->bExportPatch)
+		{
+			SavePatchDescriptionFile(TargetPackage, Platforms[PlatformIndex], PlatformCookedFiles[PlatformIndex], PlatformPatchDiffs[PlatformIndex]);
+		}
+		else
+		{
+			SavePakDescriptionFile(TargetPackage, Platforms[PlatformIndex], DependecyInfo, Tasks, PlatformCookedFiles[PlatformIndex]);
+		}
+		StageTimer.AddFiles(1, 0);
+	}
+
+	{
+		FScopeLock RootStatsLock(&RootStatsCritical);
+		RootWallSeconds.Add(TargetPackage, FPlatformTime::Seconds() - StartTime);
+	}
+
+	return bSuccess;
+}
+
+bool FExportPakExporter::ResolveTargetPlatforms()
+{
+	check(IsInGameThread());
+
+	Platforms.Empty();
+	return ResolvePlatforms(Settings->TargetPlatforms, Platforms);
+}
+
+void FExportPakExporter::Cancel()
+{
+	Status.bCancelRequested = true;
+	RootQueue.Close();
+}
+
+bool FExportPakExporter::BeginPakGeneration()
+{
+	if (Platforms.Num() == 0 && !ResolveTargetPlatforms())
+	{
+		return false;
+	}
+
+	// One walk of each cooked tree, shared by every root.
+	ExportPakParallelFor(Platforms.Num(), Platforms.Num(), EAsyncExecution::ThreadPool,
+		[this](int32 PlatformIndex)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_ExportPak_CookedIndex);
+			FExportPakScopedStageTimer StageTimer(GlobalStats, EExportPakStage::CookedIndex);
+
+			TSharedPtr<FExportPakCookedIndex> CookedIndex = MakeShareable(new FExportPakCookedIndex);
+			CookedIndex->Build(Platforms[PlatformIndex].CookedPlatformName);
+			StageTimer.AddFiles(CookedIndex->GetNumFiles(), CookedIndex->GetTotalSize());
+			Platforms[PlatformIndex].CookedIndex = CookedIndex;
+		},
+		[](int32 NumFinished) {});
+
+	ExportCache.Reset(new FExportPakCache(FExportPakCache::GetDefaultManifestFilepath()));
+	if (Settings->bSkipUnchangedPaks)
+	{
+		ExportCache->Load();
+	}
+
+	FileOpenOrder.Reset();
+	if (!Settings->FileOpenOrderLog.FilePath.IsEmpty())
+	{
+		FileOpenOrder.Reset(new FExportPakFileOpenOrder);
+		if (!FileOpenOrder->Load(Settings->FileOpenOrderLog.FilePath))
+		{
+			return false;
+		}
+	}
+
+	SharedPaks.Reset();
+	PakDigests.Empty();
+	PakSizes.Empty();
+
+	// NumRoots is set by whoever knows how many roots there are.
+	Status.NumRootsFinished.Reset();
+	Status.NumPaks.Reset();
+	Status.NumPaksFinished.Reset();
+
+	return true;
+}
+
+void FExportPakExporter::EndPakGeneration()
+{
+	if (Status.bCancelRequested)
+	{
+		UE_LOG(LogExportPak, Warning, TEXT("Export cancelled after %d of %d asset(s)."), Status.NumRootsFinished.GetValue(), Status.NumRoots.GetValue());
+	}
+
+	if (Settings->bSkipUnchangedPaks)
+	{
+		ExportCache->Save();
+	}
+	ExportCache.Reset();
+
+	SaveExportStats();
+}
+
+bool FExportPakExporter::GeneratePakFiles(const TMap<FString, FDependenciesInfo> &DependenciesInfos)
+{
+	if (!BeginPakGeneration())
+	{
+		return false;
+	}
+
+	TArray<FString> RootPackages;
+	DependenciesInfos.GetKeys(RootPackages);
+	Status.NumRoots.Set(RootPackages.Num());
+
+	FExportPakProgress Progress(static_cast<float>(RootPackages.Num()));
+	FThreadSafeBool bAllSucceeded(true);
+
+	if (Settings->MaxConcurrentRoots > 1)
+	{
+		// Root workers wait on the pak writers in the thread pool, so they must not live in it themselves.
+		int32 NumReportedRoots = 0;
+		ExportPakParallelFor(RootPackages.Num(), Settings->MaxConcurrentRoots, EAsyncExecution::Thread,
+			[this, &RootPackages, &DependenciesInfos, &bAllSucceeded](int32 RootIndex)
+			{
+				const FString& RootPackage = RootPackages[RootIndex];
+				UE_LOG(LogExportPak, Log, TEXT("Exporting Paks of asset: %s"), *RootPackage);
+				if (!GeneratePakFilesOfRoot(RootPackage, DependenciesInfos[RootPackage], *ExportCache))
+				{
+					bAllSucceeded = false;
+				}
+				Status.NumRootsFinished.Increment();
+			},
+			[&RootPackages, &Progress, &NumReportedRoots](int32 NumFinished)
+			{
+				Progress.EnterProgressFrame(static_cast<float>(NumFinished - NumReportedRoots), FText::Format(NSLOCTEXT("ExportPak", "GeneratePakFilesParallel", "Exported Paks of {0} of {1} asset(s)"), FText::AsNumber(NumFinished), FText::AsNumber(RootPackages.Num())));
+				NumReportedRoots = NumFinished;
+			});
+	}
+	else
+	{
+		for (const auto& RootPackage : RootPackages)
+		{
+			Progress.EnterProgressFrame(1.0f, FText::Format(NSLOCTEXT("ExportPak", "GeneratePakFiles", "Exporting Paks of asset: {0}"), FText::FromString(RootPackage)));
+			if (!GeneratePakFilesOfRoot(RootPackage, DependenciesInfos[RootPackage], *ExportCache))
+			{
+				bAllSucceeded = false;
+			}
+			Status.NumRootsFinished.Increment();
+		}
+	}
+
+	EndPakGeneration();
+
+	return bAllSucceeded;
+}
+
+bool FExportPakExporter::GeneratePakFilesOfQueuedRoots()
+{
+	if (!BeginPakGeneration())
+	{
+		// Nobody takes the roots any more, the walk must not wait for room.
+		RootQueue.Close();
+		return false;
+	}
+
+	FThreadSafeBool bAllSucceeded(true);
+	auto GenerateQueuedRoots = [this, &bAllSucceeded]()
+	{
+		FExportPakWalkedRoot WalkedRoot;
+		while (RootQueue.Pop(WalkedRoot))
+		{
+			UE_LOG(LogExportPak, Log, TEXT("Exporting Paks of asset: %s"), *WalkedRoot.RootPackage);
+			if (!GeneratePakFilesOfRoot(WalkedRoot.RootPackage, WalkedRoot.DependenciesInfo, *ExportCache))
+			{
+				bAllSucceeded = false;
+			}
+			Status.NumRootsFinished.Increment();
+		}
+	};
+
+	if (Settings->MaxConcurrentRoots > 1)
+	{
+		// Root workers wait on the pak writers in the thread pool, so they must not live in it themselves.
+		TArray<TFuture<void>> RootWorkers;
+		for (int32 WorkerIndex = 0; WorkerIndex < Settings->MaxConcurrentRoots; ++WorkerIndex)
+		{
+			RootWorkers.Add(Async<void>(EAsyncExecution::Thread, GenerateQueuedRoots));
+		}
+
+		for (auto& RootWorker : RootWorkers)
+		{
+			RootWorker.Wait();
+		}
+	}
+	else
+	{
+		GenerateQueuedRoots();
+	}
+
+	EndPakGeneration();
+
+	return bAllSucceeded;
+}
+
+bool FExportPakExporter::QueueRoot(const FExportPakWalkedRoot& Root)
+{
+	return RootQueue.Push(Root);
+}
+
+bool FExportPakExporter::TryQueueRoot(const FExportPakWalkedRoot& Root)
+{
+	return RootQueue.TryPush(Root);
+}
+
+void FExportPakExporter::CloseRootQueue()
+{
+	RootQueue.Close();
+}
+
+void FExportPakExporter::SavePakDescriptionFile(const FString& TargetPackage, const FExportPakPlatform& Platform, const FDependenciesInfo& DependecyInfo, const TArray<FExportPakTask>& Tasks, const TArray<FExportPakCookedFileRecord>& CookedFiles)
+{
+	FString HashedMainPackageName = HashPackageName(TargetPackage);
+	FString PakOutputDirectory = GetRootPakOutputDirectory(HashedMainPackageName, Platform);
+
+	// pak_path is relative to this description file, it points into the shared store when that is used.
+	const bool bUseSharedPakStore = UseSharedPakStore();
+	FString PakStoreDirectory = bUseSharedPakStore ? GetSharedPakStoreDirectory(Platform) : PakOutputDirectory;
+	FString PakPathPrefix = bUseSharedPakStore ? TEXT("../Shared/") : TEXT("");
+
+	FString PakDescriptionFilename = FPaths::Combine(PakOutputDirectory,  HashedMainPackageName + TEXT(".json"));
+	PakDescriptionFilename = FPaths::ConvertRelativePathToFull(PakDescriptionFilename);
+
+	// Streamed as UTF-8 straight into the file, the fields come out in the same order the FJsonObject used to keep.
+	FExportPakJsonFileArchive JsonFile(PakDescriptionFilename);
+	if (!JsonFile.IsOpen())
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to save pak description file: %s"), *PakDescriptionFilename);
+		return;
+	}
+
+	// Paks of the grouping rules, and the one each grouped package of the root is in.
+	TArray<const FExportPakTask*> GroupTasks;
+	TMap<FString, const FExportPakTask*> GroupedPackageTasks;
+	for (const auto& Task : Tasks)
+	{
+		if (Task.CookedPlatformName == Platform.CookedPlatformName && !Task.GroupName.IsEmpty())
+		{
+			GroupTasks.Add(&Task);
+			for (const auto& Package : Task.Packages)
+			{
+				GroupedPackageTasks.Add(Package, &Task);
+			}
+		}
+	}
+
+	TSharedRef<FExportPakJsonWriter> JsonWirter = FExportPakJsonWriter::Create(&JsonFile);
+	JsonWirter->WriteObjectStart();
+	{
+		JsonWirter->WriteValue(TEXT("long_package_name"), TargetPackage);
+		JsonWirter->WriteValue(TEXT("platform"), Platform.CookedPlatformName);
+
+		FString PakFilename = HashedMainPackageName + TEXT(".pak");
+		FString PakPath = PakPathPrefix + PakFilename;
+		FString PakFilepath = FPaths::Combine(PakStoreDirectory, PakFilename);
+		if (const FExportPakTask* const* RootGroupTask = GroupedPackageTasks.Find(TargetPackage))
+		{
+			// Group paks are never in the shared store.
+			PakFilepath = (*RootGroupTask)->OutputPakFilepath;
+			PakFilename = FPaths::GetCleanFilename(PakFilepath);
+			PakPath = PakFilename;
+		}
+		else if (Settings->bUseBatchMode)
+		{
+			// A chunked batch pak has no <hash>.pak, point at its first chunk.
+			const FExportPakTask* FirstChunk = Tasks.FindByPredicate([&Platform](const FExportPakTask& Task) { return Task.CookedPlatformName == Platform.CookedPlatformName && Task.bBatchChunk; });
+			if (FirstChunk != nullptr)
+			{
+				PakFilename = FPaths::GetCleanFilename(FirstChunk->OutputPakFilepath);
+				PakPath = PakPathPrefix + PakFilename;
+				PakFilepath = FPaths::Combine(PakStoreDirectory, PakFilename);
+			}
+		}
+
+		JsonWirter->WriteValue(TEXT("pak_file"), PakFilename);
+		JsonWirter->WriteValue(TEXT("pak_path"), PakPath);
+		JsonWirter->WriteValue(TEXT("asset_class"), DependecyInfo.AssetClassString);
+		WritePakSizeFields(*JsonWirter, GetPakSizes(PakFilepath), FindPakDigest(PakFilepath).Get());
+	}
+
+	JsonWirter->WriteArrayStart(TEXT("dependencies_in_game_content_dir"));
+	for (const auto& DependencyInGameContentDir : DependecyInfo.DependenciesInGameContentDir)
+	{
+		FString HashedPackageName = HashPackageName(DependencyInGameContentDir);
+
+		JsonWirter->WriteObjectStart();
+		JsonWirter->WriteValue(TEXT("long_package_name"), DependencyInGameContentDir);
+		if (const FExportPakTask* const* GroupTask = GroupedPackageTasks.Find(DependencyInGameContentDir))
+		{
+			const FString GroupPakFilename = FPaths::GetCleanFilename((*GroupTask)->OutputPakFilepath);
+			JsonWirter->WriteValue(TEXT("pak_file"), GroupPakFilename);
+			JsonWirter->WriteValue(TEXT("pak_path"), GroupPakFilename);
+			WritePakSizeFields(*JsonWirter, GetPakSizes((*GroupTask)->OutputPakFilepath), FindPakDigest((*GroupTask)->OutputPakFilepath).Get());
+		}
+		else
+		{
+			JsonWirter->WriteValue(TEXT("pak_file"), HashedPackageName + TEXT(".pak"));
+			JsonWirter->WriteValue(TEXT("pak_path"), PakPathPrefix + HashedPackageName + TEXT(".pak"));
+			const FString DependencyPakFilepath = FPaths::Combine(PakStoreDirectory, HashedPackageName + TEXT(".pak"));
+			WritePakSizeFields(*JsonWirter, GetPakSizes(DependencyPakFilepath), FindPakDigest(DependencyPakFilepath).Get());
+		}
+		JsonWirter->WriteObjectEnd();
+	}
+	JsonWirter->WriteArrayEnd();
+
+	if (FileOpenOrder.IsValid())
+	{
+		JsonWirter->WriteArrayStart(TEXT("file_open_order"));
+		for (const auto& Task : Tasks)
+		{
+			if (Task.CookedPlatformName != Platform.CookedPlatformName || Task.NumFilesInOpenOrder == 0)
+			{
+				continue;
+			}
+
+			JsonWirter->WriteObjectStart();
+			JsonWirter->WriteValue(TEXT("pak_file"), FPaths::GetCleanFilename(Task.OutputPakFilepath));
+			JsonWirter->WriteValue(TEXT("ordered_files"), Task.NumFilesInOpenOrder);
+			JsonWirter->WriteValue(TEXT("files"), Task.Files.Num());
+			JsonWirter->WriteValue(TEXT("seeks_in_discovery_order"), Task.SeeksBeforeOpenOrder);
+			JsonWirter->WriteValue(TEXT("seeks_in_open_order"), Task.SeeksInOpenOrder);
+			JsonWirter->WriteObjectEnd();
+		}
+		JsonWirter->WriteArrayEnd();
+	}
+
+	if (GroupTasks.Num() > 0)
+	{
+		JsonWirter->WriteArrayStart(TEXT("pak_groups"));
+		for (const FExportPakTask* GroupTask : GroupTasks)
+		{
+			JsonWirter->WriteObjectStart();
+			JsonWirter->WriteValue(TEXT("group"), GroupTask->GroupName);
+			JsonWirter->WriteValue(TEXT("pak_file"), FPaths::GetCleanFilename(GroupTask->OutputPakFilepath));
+			JsonWirter->WriteValue(TEXT("pak_path"), FPaths::GetCleanFilename(GroupTask->OutputPakFilepath));
+			WritePakSizeFields(*JsonWirter, GetPakSizes(GroupTask->OutputPakFilepath), FindPakDigest(GroupTask->OutputPakFilepath).Get());
+
+			JsonWirter->WriteArrayStart(TEXT("packages"));
+			for (const auto& Package : GroupTask->Packages)
+			{
+				JsonWirter->WriteValue(Package);
+			}
+			JsonWirter->WriteArrayEnd();
+			JsonWirter->WriteObjectEnd();
+		}
+		JsonWirter->WriteArrayEnd();
+	}
+
+	// Batch paks may be split by MaxBatchPakSizeInMegabytes, every chunk has to be mounted.
+	if (Settings->bUseBatchMode)
+	{
+		JsonWirter->WriteArrayStart(TEXT("pak_chunks"));
+		for (const auto& Task : Tasks)
+		{
+			if (Task.CookedPlatformName != Platform.CookedPlatformName || !Task.bBatchChunk)
+			{
+				continue;
+			}
+
+			JsonWirter->WriteObjectStart();
+			JsonWirter->WriteValue(TEXT("pak_file"), FPaths::GetCleanFilename(Task.OutputPakFilepath));
+			JsonWirter->WriteValue(TEXT("pak_path"), FPaths::GetCleanFilename(Task.OutputPakFilepath));
+			WritePakSizeFields(*JsonWirter, GetPakSizes(Task.OutputPakFilepath), FindPakDigest(Task.OutputPakFilepath).Get());
+
+			JsonWirter->WriteArrayStart(TEXT("packages"));
+			for (const auto& Package : Task.Packages)
+			{
+				JsonWirter->WriteValue(Package);
+			}
+			JsonWirter->WriteArrayEnd();
+			JsonWirter->WriteObjectEnd();
+		}
+		JsonWirter->WriteArrayEnd();
+	}
+
+	// Only recorded with Settings->bRecordCookedFileHashes.
+	if (CookedFiles.Num() > 0)
+	{
+		WriteCookedFilesField(*JsonWirter, CookedFiles);
+	}
+
+	JsonWirter->WriteObjectEnd();
+	JsonWirter->Close();
+
+	if (!JsonFile.Close())
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to save pak description file: %s"), *PakDescriptionFilename);
+	}
+}
+
+void FExportPakExporter::SavePatchDescriptionFile(const FString& TargetPackage, const FExportPakPlatform& Platform, const TArray<FExportPakCookedFileRecord>& CookedFiles, const FExportPakPatchDiff& Diff)
+{
+	FString HashedMainPackageName = HashPackageName(TargetPackage);
+	FString PakOutputDirectory = GetRootPakOutputDirectory(HashedMainPackageName, Platform);
+
+	// The description file of the baseline is left alone, so the same baseline can be patched again.
+	FString PatchDescriptionFilename = FPaths::Combine(PakOutputDirectory, HashedMainPackageName + TEXT("_P.json"));
+	PatchDescriptionFilename = FPaths::ConvertRelativePathToFull(PatchDescriptionFilename);
+
+	FExportPakJsonFileArchive JsonFile(PatchDescriptionFilename);
+	if (!JsonFile.IsOpen())
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to save patch description file: %s"), *PatchDescriptionFilename);
+		return;
+	}
+
+	// No pak_file when only files were deleted.
+	const bool bHasPatchPak = Diff.ChangedFiles.Num() + Diff.AddedFiles.Num() > 0;
+	FString PakFilename = bHasPatchPak ? HashedMainPackageName + TEXT("_P.pak") : FString();
+
+	TSharedRef<FExportPakJsonWriter> JsonWirter = FExportPakJsonWriter::Create(&JsonFile);
+	JsonWirter->WriteObjectStart();
+	JsonWirter->WriteValue(TEXT("long_package_name"), TargetPackage);
+	JsonWirter->WriteValue(TEXT("platform"), Platform.CookedPlatformName);
+	JsonWirter->WriteValue(TEXT("baseline_description_file"), FPaths::ConvertRelativePathToFull(FExportPakPatch::GetBaselineDescriptionFilepath(Settings->PatchBaselineDirectory.Path, Platform.CookedPlatformName, HashedMainPackageName)));
+	JsonWirter->WriteValue(TEXT("pak_file"), PakFilename);
+	JsonWirter->WriteValue(TEXT("pak_path"), PakFilename);
+	const FString PatchPakFilepath = FPaths::Combine(PakOutputDirectory, PakFilename);
+	WritePakSizeFields(*JsonWirter, GetPakSizes(PatchPakFilepath), FindPakDigest(PatchPakFilepath).Get());
+
+	WriteCookedFilePaths(*JsonWirter, TEXT("changed_files"), CookedFiles, Diff.ChangedFiles);
+	WriteCookedFilePaths(*JsonWirter, TEXT("added_files"), CookedFiles, Diff.AddedFiles);
+
+	// A pak cannot hide a file of an older pak, the game has to skip these itself.
+	JsonWirter->WriteArrayStart(TEXT("deleted_files"));
+	for (const auto& DeletedFile : Diff.DeletedFiles)
+	{
+		JsonWirter->WriteValue(DeletedFile);
+	}
+	JsonWirter->WriteArrayEnd();
+
+	JsonWirter->WriteObjectEnd();
+	JsonWirter->Close();
+
+	if (!JsonFile.Close())
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to save patch description file: %s"), *PatchDescriptionFilename);
+	}
+}
+
+/** AssetDependencies.json: an object per root with its AssetClass, DependenciesInGameContentDir and OtherDependencies. */
+bool SaveDependenciesInfoJson(const FString& Filepath, const TMap<FString, FDependenciesInfo>& DependenciesInfos)
+{
+	FExportPakJsonFileArchive JsonFile(Filepath);
+	if (!JsonFile.IsOpen())
+	{
+		return false;
+	}
+
+	TSharedRef<FExportPakJsonWriter> JsonWirter = FExportPakJsonWriter::Create(&JsonFile);
+	JsonWirter->WriteObjectStart();
+	for (auto &DependenciesInfoEntry : DependenciesInfos)
+	{
+		JsonWirter->WriteObjectStart(DependenciesInfoEntry.Key);
+
+		// Write current AssetClass.
+		JsonWirter->WriteValue(TEXT("AssetClass"), DependenciesInfoEntry.Value.AssetClassString);
+
+		// Write dependencies in game content dir.
+		JsonWirter->WriteArrayStart(TEXT("DependenciesInGameContentDir"));
+		for (auto &d : DependenciesInfoEntry.Value.DependenciesInGameContentDir)
+		{
+			JsonWirter->WriteValue(d);
+		}
+		JsonWirter->WriteArrayEnd();
+
+		// Write dependencies not in game content dir.
+		JsonWirter->WriteArrayStart(TEXT("OtherDependencies"));
+		for (auto &d : DependenciesInfoEntry.Value.OtherDependencies)
+		{
+			JsonWirter->WriteValue(d);
+		}
+		JsonWirter->WriteArrayEnd();
+
+		JsonWirter->WriteObjectEnd();
+	}
+	JsonWirter->WriteObjectEnd();
+	JsonWirter->Close();
+
+	return JsonFile.Close();
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakDependenciesJsonBenchmark, "ExportPak.DependenciesJson.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakDependenciesJsonBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumRoots = 50000;
+	const int32 NumDependenciesPerRoot = 8;
+
+	TMap<FString, FDependenciesInfo> DependenciesInfos;
+	for (int32 RootIndex = 0; RootIndex < NumRoots; ++RootIndex)
+	{
+		FDependenciesInfo& DependenciesInfo = DependenciesInfos.Add(FString::Printf(TEXT("/Game/Synthetic/Folder_%d/Root_%d"), RootIndex / 100, RootIndex));
+		DependenciesInfo.AssetClassString = TEXT("World");
+		for (int32 DependencyIndex = 0; DependencyIndex < NumDependenciesPerRoot; ++DependencyIndex)
+		{
+			DependenciesInfo.DependenciesInGameContentDir.Add(FString::Printf(TEXT("/Game/Synthetic/Shared/Asset_%d"), (RootIndex * 7 + DependencyIndex) % 5000));
+		}
+		DependenciesInfo.OtherDependencies.Add(TEXT("/Script/Engine"));
+	}
+	// Non-ASCII names must come out as UTF-8 in both.
+	DependenciesInfos.Add(TEXT("/Game/Maps/\u5730\u56FE")).AssetClassString = TEXT("World");
+
+	const FString LegacyFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/DependenciesJsonBenchmark_Legacy.json"));
+	const FString StreamedFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/DependenciesJsonBenchmark_Streamed.json"));
+
+	// The way AssetDependencies.json used to be written: a DOM, one FString, then UTF-8 conversion of all of it.
+	const uint64 LegacyStartMemory = FPlatformMemory::GetStats().UsedPhysical;
+	double StartTime = FPlatformTime::Seconds();
+	uint64 LegacyPeakMemory = 0;
+	{
+		TSharedPtr<FJsonObject> RootJsonObject = MakeShareable(new FJsonObject);
+		for (auto &DependenciesInfoEntry : DependenciesInfos)
+		{
+			TSharedPtr<FJsonObject> EntryJsonObject = MakeShareable(new FJsonObject);
+			EntryJsonObject->SetStringField("AssetClass", DependenciesInfoEntry.Value.AssetClassString);
+
+			TArray< TSharedPtr<FJsonValue> > DependenciesEntry;
+			for (auto &d : DependenciesInfoEntry.Value.DependenciesInGameContentDir)
+			{
+				DependenciesEntry.Add(MakeShareable(new FJsonValueString(d)));
+			}
+			EntryJsonObject->SetArrayField("DependenciesInGameContentDir", DependenciesEntry);
+
+			TArray< TSharedPtr<FJsonValue> > OtherDependenciesEntry;
+			for (auto &d : DependenciesInfoEntry.Value.OtherDependencies)
+			{
+				OtherDependenciesEntry.Add(MakeShareable(new FJsonValueString(d)));
+			}
+			EntryJsonObject->SetArrayField("OtherDependencies", OtherDependenciesEntry);
+
+			RootJsonObject->SetObjectField(DependenciesInfoEntry.Key, EntryJsonObject);
+		}
+
+		FString OutputString;
+		auto JsonWirter = TJsonWriterFactory<>::Create(&OutputString);
+		FJsonSerializer::Serialize(RootJsonObject.ToSharedRef(), JsonWirter);
+
+		LegacyPeakMemory = FPlatformMemory::GetStats().UsedPhysical;
+		FFileHelper::SaveStringToFile(OutputString, *LegacyFilepath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	}
+	const double LegacyTime = FPlatformTime::Seconds() - StartTime;
+
+	const uint64 StreamedStartMemory = FPlatformMemory::GetStats().UsedPhysical;
+	StartTime = FPlatformTime::Seconds();
+	TestTrue(TEXT("Save"), SaveDependenciesInfoJson(StreamedFilepath, DependenciesInfos));
+	const double StreamedTime = FPlatformTime::Seconds() - StartTime;
+	const uint64 StreamedEndMemory = FPlatformMemory::GetStats().UsedPhysical;
+
+	// Working set growth is only indicative, the allocator keeps freed memory around.
+	UE_LOG(LogExportPak, Display, TEXT("DependenciesJson benchmark: %d roots, DOM + FString %.3f s %+.1f MB, streamed %.3f s %+.1f MB."),
+		DependenciesInfos.Num(),
+		LegacyTime, ((int64)LegacyPeakMemory - (int64)LegacyStartMemory) / (1024.0 * 1024.0),
+		StreamedTime, ((int64)StreamedEndMemory - (int64)StreamedStartMemory) / (1024.0 * 1024.0));
+
+	TArray<uint8> LegacyBytes;
+	TArray<uint8> StreamedBytes;
+	FFileHelper::LoadFileToArray(LegacyBytes, *LegacyFilepath);
+	FFileHelper::LoadFileToArray(StreamedBytes, *StreamedFilepath);
+	TestTrue(TEXT("Same bytes as the legacy path"), LegacyBytes == StreamedBytes);
+
+	IFileManager::Get().Delete(*LegacyFilepath);
+	IFileManager::Get().Delete(*StreamedFilepath);
+
+	return true;
+}
+
+bool FExportPakExporter::SaveDependenciesInfo(const TMap<FString, FDependenciesInfo> &DependenciesInfos)
+{
+	bool bManifestSaved = FExportPakManifestWriter::Save(GetDependenciesManifestFilepath(), DependenciesInfos, GetNameHash());
+	if (!Settings->bSaveDependenciesInfoJson)
+	{
+		return bManifestSaved;
+	}
+
+	FString ResultFileFilename = GetDependenciesInfoFilepath();
+	bool bSaveSuccess = SaveDependenciesInfoJson(ResultFileFilename, DependenciesInfos);
+	if (!bSaveSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to export %s"), *ResultFileFilename);
+	}
+
+	return bManifestSaved && bSaveSuccess;
+}
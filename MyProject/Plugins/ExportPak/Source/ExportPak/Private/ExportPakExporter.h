@@ -0,0 +1,300 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Templates/UniquePtr.h"
+#include "ExportPakStats.h"
+#include "ExportPakParallel.h"
+#include "ExportPakManifest.h"
+#include "ExportPakSharedPakStore.h"
+
+class UExportPakSettings;
+class FExportPakCache;
+class FExportPakFileOpenOrder;
+class FExportPakCookedIndex;
+class FExportPakDependencyWalker;
+struct FExportPakTask;
+struct FExportPakCompressionProfile;
+struct FExportPakFileEntry;
+struct FExportPakCookedFileRecord;
+struct FExportPakDigest;
+struct FExportPakPatchDiff;
+
+struct FDependenciesInfo
+{
+	TArray<FString> DependenciesInGameContentDir;
+	TArray<FString> OtherDependencies;
+	FString AssetClassString;
+};
+
+/** A root whose dependencies were walked, on its way to pak generation. */
+struct FExportPakWalkedRoot
+{
+	FString RootPackage;
+	FDependenciesInfo DependenciesInfo;
+};
+
+/** A cooked platform to export, e.g. WindowsNoEditor, and the platform name UnrealPak reads the ini files of. */
+struct FExportPakPlatform
+{
+	FString CookedPlatformName;
+	FString IniPlatformName;
+
+	/** Cooked files of this platform, built once per export. */
+	TSharedPtr<const FExportPakCookedIndex> CookedIndex;
+};
+
+/** Sizes the description files report for a pak, -1 when it cannot be read. */
+struct FExportPakSizes
+{
+	FExportPakSizes()
+		:
+		FileSize(-1),
+		CompressedSize(-1),
+		RawSize(-1)
+	{
+	}
+
+	int64 FileSize;
+
+	/** Stored and uncompressed size of the entries, from the index of the pak. */
+	int64 CompressedSize;
+	int64 RawSize;
+};
+
+/** Progress of a running export. Written by the export threads, may be read and cancelled from any thread. */
+struct FExportPakStatus
+{
+	FThreadSafeCounter NumRoots;
+	FThreadSafeCounter NumRootsFinished;
+
+	/** Paks queued so far, grows while roots are being processed. Up-to-date paks count as finished. */
+	FThreadSafeCounter NumPaks;
+	FThreadSafeCounter NumPaksFinished;
+
+	FThreadSafeBool bCancelRequested;
+};
+
+/** Pak files and description files are named with the SHA1 of the long package name. Cached, thread-safe. */
+FString HashStringWithSHA1(const FString &InString, EExportPakNameHash NameHash = EExportPakNameHash::Utf8);
+
+/**
+ * The export pipeline: gather the dependencies of the root packages, save them, then generate the pak files
+ * and a description file per root.
+ * It does not touch any UI, so the SExportPak tab and UExportPakCommandlet both drive it.
+ */
+class FExportPakExporter
+{
+public:
+	explicit FExportPakExporter(const UExportPakSettings* InSettings);
+
+	~FExportPakExporter();
+
+	/**
+	 * Run every stage for Settings->PackagesToExport, pipelined: the paks of a root are generated on worker threads
+	 * while the next roots are still being walked on this one. Returns false if any of them failed. Game thread.
+	 */
+	bool Export();
+
+	void GetAssetDependecies(TMap<FString, FDependenciesInfo>& DependenciesInfos);
+
+	/** GetAssetDependecies() a root at a time. Looks up all roots in one asset registry query. Game thread. */
+	void BeginDependencyWalk();
+
+	/** Walk the next root, roots the registry does not know are skipped. Returns false when there is none left. Game thread. */
+	bool WalkNextRoot(FExportPakWalkedRoot& OutRoot);
+
+	/**
+	 * This will save the dependencies information to GetDependenciesManifestFilepath(),
+	 * and to GetDependenciesInfoFilepath() as well if Settings->bSaveDependenciesInfoJson.
+	 */
+	bool SaveDependenciesInfo(const TMap<FString, FDependenciesInfo> &DependenciesInfos);
+
+	/**
+	 * Map Settings->TargetPlatforms to target platforms. Must run on the game thread,
+	 * GeneratePakFiles() does it itself when it was not done before.
+	 */
+	bool ResolveTargetPlatforms();
+
+	/**
+	 * Roots are processed Settings->MaxConcurrentRoots at a time, each for every platform of Settings->TargetPlatforms.
+	 * Can run on any thread once ResolveTargetPlatforms() succeeded, there is no progress dialog then.
+	 */
+	bool GeneratePakFiles(const TMap<FString, FDependenciesInfo> &DependenciesInfos);
+
+	/**
+	 * GeneratePakFiles() for roots handed over one by one with QueueRoot() or TryQueueRoot(), Settings->MaxConcurrentRoots at a time.
+	 * Runs on another thread than the walk, after ResolveTargetPlatforms(). Returns once CloseRootQueue() was called and
+	 * every queued root is done.
+	 */
+	bool GeneratePakFilesOfQueuedRoots();
+
+	/** Waits while the queue of walked roots is full. Returns false if the queue was closed, e.g. by Cancel(). */
+	bool QueueRoot(const FExportPakWalkedRoot& Root);
+
+	/** Returns false without waiting if the queue of walked roots is full or closed. */
+	bool TryQueueRoot(const FExportPakWalkedRoot& Root);
+
+	/** No more roots, GeneratePakFilesOfQueuedRoots() returns once the queued ones are done. */
+	void CloseRootQueue();
+
+	/** Stop a running GeneratePakFiles() as soon as possible: no new pak is started and UnrealPak processes are killed. */
+	void Cancel();
+
+	const FExportPakStatus& GetStatus() const
+	{
+		return Status;
+	}
+
+	/** Saved/ExportPak/AssetDependencies.json */
+	static FString GetDependenciesInfoFilepath();
+
+	/** Saved/ExportPak/AssetDependencies.bin, read it with FExportPakManifest. */
+	static FString GetDependenciesManifestFilepath();
+
+	/**
+	 * Time, files and bytes of every stage, in total and per root, to GetExportStatsFilepath().
+	 * GeneratePakFiles() calls it when it is done.
+	 */
+	bool SaveExportStats();
+
+	/** Saved/ExportPak/ExportStats.json */
+	static FString GetExportStatsFilepath();
+
+private:
+	/** Cooked indices, export cache and status shared by the roots of a GeneratePakFiles() run. */
+	bool BeginPakGeneration();
+
+	void EndPakGeneration();
+
+	bool GeneratePakFilesOfRoot(const FString& TargetPackage, const FDependenciesInfo& DependecyInfo, FExportPakCache& ExportCache);
+
+	/** One pak per package. With the shared store, packages another root of this export claimed are skipped. */
+	void AddIndividualPakTasks(const TArray<FString>& PackagesToHandle, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks);
+
+	/** One pak with all the packages of a root, or several if it would exceed Settings->MaxBatchPakSizeInMegabytes. */
+	void AddBatchPakTask(const TArray<FString>& PackagesToHandle, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks);
+
+	/** Packages no grouping rule takes, packages of rules without a GroupName, and the packages of each group. */
+	void SplitPackagesByGroup(const TArray<FString>& PackagesToHandle, TArray<FString>& OutModePackages, TArray<FString>& OutOwnPakPackages, TMap<FString, TArray<FString>>& OutGroupPackages);
+
+	/** <hash of the root>_<GroupName>.pak with the packages of the root a grouping rule put together. */
+	void AddGroupPakTask(const FString& GroupName, const TArray<FString>& GroupPackages, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks);
+
+	/** Lay the files of every pak out in the order of Settings->FileOpenOrderLog, and count the seeks before and after. */
+	void ApplyFileOpenOrder(TArray<FExportPakTask>& Tasks) const;
+
+	/**
+	 * A <hash>_P.pak with the cooked files of the root that differ from its description file in Settings->PatchBaselineDirectory.
+	 * Adds no task if nothing changed or was added. OutCookedFiles and OutDiff are what the patch description file lists.
+	 */
+	bool AddPatchPakTask(const TArray<FString>& PackagesToHandle, const FString& MainPackage, const FExportPakPlatform& Platform, FExportPakCache& ExportCache, FExportPakStats& Stats, TArray<FExportPakTask>& OutTasks, TArray<FExportPakCookedFileRecord>& OutCookedFiles, FExportPakPatchDiff& OutDiff);
+
+	/** Cooked files of all the packages with their compression profile applied, and their hashes from FExportPakCache::HashInput(). */
+	bool GatherCookedFilesOfRoot(const TArray<FString>& PackagesToHandle, const FExportPakPlatform& Platform, FExportPakCache& ExportCache, FExportPakStats& Stats, TArray<FExportPakFileEntry>& OutFiles, TArray<FExportPakCookedFileRecord>& OutCookedFiles);
+
+	/** Check the entries of a written pak against its task and record its digest. Logs what differs. Thread-safe. */
+	bool VerifyPak(const FExportPakTask& Task, FExportPakStats& Stats);
+
+	/** Null if the pak was not verified in this export. */
+	TSharedPtr<const FExportPakDigest> FindPakDigest(const FString& PakFilepath);
+
+	/** Reads the index of a pak once per export, however many description files list it. Thread-safe. */
+	FExportPakSizes GetPakSizes(const FString& PakFilepath);
+
+	bool RunPakTasks(const TArray<FExportPakTask>& Tasks, FExportPakCache& ExportCache, FExportPakStats& Stats, TArray<bool>& OutTaskSucceeded);
+
+	/** Mark the shared store paks of the tasks as written or failed, so the roots waiting for them can go on. */
+	void FinishSharedPaks(const TArray<FExportPakTask>& Tasks, const TArray<bool>& TaskSucceeded);
+
+	/** Stats of the stages run on behalf of a root, created on first use. Thread-safe. */
+	FExportPakStats& GetRootStats(const FString& RootPackage);
+
+	/** Tasks are the paks generated for this root, in batch mode they are listed as its chunks. */
+	void SavePakDescriptionFile(const FString& TargetPackage, const FExportPakPlatform& Platform, const FDependenciesInfo& DependecyInfo, const TArray<FExportPakTask>& Tasks, const TArray<FExportPakCookedFileRecord>& CookedFiles);
+
+	/** <hash>_P.json next to the patch pak, with what changed since the baseline. */
+	void SavePatchDescriptionFile(const FString& TargetPackage, const FExportPakPlatform& Platform, const TArray<FExportPakCookedFileRecord>& CookedFiles, const FExportPakPatchDiff& Diff);
+
+	bool UseSharedPakStore() const;
+
+	/** Settings->bLegacyPackageNameHashes as the hashing mode. */
+	EExportPakNameHash GetNameHash() const;
+
+	/** HashStringWithSHA1() with the hashing mode of this export. */
+	FString HashPackageName(const FString& PackageName) const;
+
+	/** Compression profiles or grouping rules look at the asset class of every package. */
+	bool NeedsPackageAssetClasses() const;
+
+	/** Empty if the class is unknown or was not looked up. Thread-safe. */
+	FString GetPackageAssetClass(const FString& PackageName);
+
+	/** Profile of the asset class of the package, DefaultCompression when none matches. */
+	const FExportPakCompressionProfile& GetCompressionProfile(const FString& PackageName);
+
+private:
+	const UExportPakSettings* Settings;
+
+	/** Settings->TargetPlatforms, resolved by ResolveTargetPlatforms(). */
+	TArray<FExportPakPlatform> Platforms;
+
+	/** Individual paks of the shared store claimed by a root of this export, and whether they are written. */
+	FExportPakSharedPakStore SharedPaks;
+
+	/** Digests of the paks VerifyPak() checked in this export, by full path. */
+	TMap<FString, TSharedPtr<const FExportPakDigest>> PakDigests;
+
+	FCriticalSection PakDigestsCritical;
+
+	/** Sizes of the readable paks GetPakSizes() was asked for in this export, by full path. */
+	TMap<FString, FExportPakSizes> PakSizes;
+
+	FCriticalSection PakSizesCritical;
+
+	/** State of the walk between BeginDependencyWalk() and the last WalkNextRoot(). */
+	TUniquePtr<FExportPakDependencyWalker> DependencyWalker;
+
+	TArray<FName> RootPackageNames;
+
+	/** Asset class of the roots the asset registry knows. */
+	TMap<FName, FString> RootAssetClasses;
+
+	int32 NextRootIndex;
+
+	/** Walked roots waiting for GeneratePakFilesOfQueuedRoots(), bounded so the walk cannot run far ahead of the paks. */
+	TExportPakBoundedQueue<FExportPakWalkedRoot> RootQueue;
+
+	/**
+	 * Asset class of every package walked so far, only filled when NeedsPackageAssetClasses().
+	 * Grows while paks are generated in a pipelined export.
+	 */
+	TMap<FString, FString> PackageAssetClasses;
+
+	FCriticalSection PackageAssetClassesCritical;
+
+	/** Valid between BeginPakGeneration() and EndPakGeneration(). */
+	TUniquePtr<FExportPakCache> ExportCache;
+
+	/** Loaded by BeginPakGeneration(), null when Settings->FileOpenOrderLog is not set. */
+	TUniquePtr<FExportPakFileOpenOrder> FileOpenOrder;
+
+	FExportPakStatus Status;
+
+	/** Stages shared by all roots, like indexing the cooked trees. */
+	FExportPakStats GlobalStats;
+
+	TMap<FString, TSharedPtr<FExportPakStats>> RootStats;
+
+	/** Time GeneratePakFilesOfRoot() took for each root. */
+	TMap<FString, double> RootWallSeconds;
+
+	/** Guards RootStats and RootWallSeconds, not the stats themselves. */
+	FCriticalSection RootStatsCritical;
+
+	double CreationTime;
+};
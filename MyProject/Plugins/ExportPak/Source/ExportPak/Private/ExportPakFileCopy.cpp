@@ -0,0 +1,233 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakFileCopy.h"
+#include "ExportPak.h"
+
+#define EXPORTPAK_CAN_MAP_FILES (PLATFORM_LINUX || PLATFORM_MAC)
+
+#if EXPORTPAK_CAN_MAP_FILES
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if PLATFORM_LINUX
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
+namespace ExportPakFileCopy
+{
+	/** Bytes asked for per copy call, the kernel may do less. */
+	static const int64 MaxCopyChunkSize = 64 * 1024 * 1024;
+
+#if PLATFORM_LINUX
+	/** The call exists but cannot do this pair of files, the next method can. */
+	static bool IsUnsupportedError(int32 Error)
+	{
+		return Error == ENOSYS || Error == EXDEV || Error == EINVAL || Error == EOPNOTSUPP || Error == ENOTSUP;
+	}
+#endif
+}
+
+FExportPakMappedFile::FExportPakMappedFile()
+	:
+	FileDescriptor(-1),
+	Data(nullptr),
+	Size(0)
+{
+}
+
+FExportPakMappedFile::~FExportPakMappedFile()
+{
+	Close();
+}
+
+bool FExportPakMappedFile::Open(const FString& Filepath)
+{
+	Close();
+
+#if EXPORTPAK_CAN_MAP_FILES
+	FileDescriptor = open(TCHAR_TO_UTF8(*Filepath), O_RDONLY);
+	if (FileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat FileStat;
+	if (fstat(FileDescriptor, &FileStat) != 0 || FileStat.st_size <= 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* MappedData = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+	if (MappedData == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	// Read once, front to back.
+	madvise(MappedData, FileStat.st_size, MADV_SEQUENTIAL);
+
+	Data = static_cast<const uint8*>(MappedData);
+	Size = FileStat.st_size;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FExportPakMappedFile::Close()
+{
+#if EXPORTPAK_CAN_MAP_FILES
+	if (Data != nullptr)
+	{
+		munmap(const_cast<uint8*>(Data), Size);
+	}
+	if (FileDescriptor >= 0)
+	{
+		close(FileDescriptor);
+	}
+#endif
+
+	FileDescriptor = -1;
+	Data = nullptr;
+	Size = 0;
+}
+
+FExportPakCopyTarget::FExportPakCopyTarget()
+	:
+	FileDescriptor(-1),
+	bCanCopyFileRange(PLATFORM_LINUX),
+	bCanSendFile(PLATFORM_LINUX)
+{
+}
+
+FExportPakCopyTarget::~FExportPakCopyTarget()
+{
+	Close();
+}
+
+bool FExportPakCopyTarget::Open(const FString& Filepath)
+{
+	Close();
+
+#if EXPORTPAK_CAN_MAP_FILES
+	FileDescriptor = open(TCHAR_TO_UTF8(*Filepath), O_WRONLY);
+	return FileDescriptor >= 0;
+#else
+	return false;
+#endif
+}
+
+void FExportPakCopyTarget::Close()
+{
+#if EXPORTPAK_CAN_MAP_FILES
+	if (FileDescriptor >= 0)
+	{
+		close(FileDescriptor);
+	}
+#endif
+
+	FileDescriptor = -1;
+}
+
+bool FExportPakCopyTarget::CopyFrom(const FExportPakMappedFile& Source, int64 DestOffset, EExportPakCopyMethod& OutMethod)
+{
+	check(IsOpen() && Source.GetData() != nullptr);
+
+#if EXPORTPAK_CAN_MAP_FILES
+	int64 CopiedSize = 0;
+
+#if PLATFORM_LINUX && defined(__NR_copy_file_range)
+	// Called through syscall(), the glibc wrapper is newer than the toolchain's sysroot.
+	// On btrfs and XFS the range is shared with the cooked file instead of copied.
+	while (bCanCopyFileRange && CopiedSize < Source.GetSize())
+	{
+		loff_t SourceOffset = CopiedSize;
+		loff_t TargetOffset = DestOffset + CopiedSize;
+		const int64 ChunkSize = FMath::Min(Source.GetSize() - CopiedSize, ExportPakFileCopy::MaxCopyChunkSize);
+		const int64 Result = syscall(__NR_copy_file_range, Source.FileDescriptor, &SourceOffset, FileDescriptor, &TargetOffset, (size_t)ChunkSize, 0u);
+		if (Result > 0)
+		{
+			CopiedSize += Result;
+			OutMethod = EExportPakCopyMethod::CopyFileRange;
+		}
+		else if (Result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		else if (Result < 0 && ExportPakFileCopy::IsUnsupportedError(errno))
+		{
+			UE_LOG(LogExportPak, Verbose, TEXT("copy_file_range unavailable (errno %d), falling back to sendfile."), errno);
+			bCanCopyFileRange = false;
+		}
+		else
+		{
+			// An error or an unexpected end of the source, the mapped write below finishes or reports it.
+			break;
+		}
+	}
+#else
+	bCanCopyFileRange = false;
+#endif
+
+#if PLATFORM_LINUX
+	if (bCanSendFile && CopiedSize < Source.GetSize() && lseek(FileDescriptor, DestOffset + CopiedSize, SEEK_SET) >= 0)
+	{
+		while (CopiedSize < Source.GetSize())
+		{
+			off_t SourceOffset = CopiedSize;
+			const int64 ChunkSize = FMath::Min(Source.GetSize() - CopiedSize, ExportPakFileCopy::MaxCopyChunkSize);
+			const ssize_t Result = sendfile(FileDescriptor, Source.FileDescriptor, &SourceOffset, (size_t)ChunkSize);
+			if (Result > 0)
+			{
+				CopiedSize += Result;
+				OutMethod = EExportPakCopyMethod::SendFile;
+			}
+			else if (Result < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			else
+			{
+				if (Result < 0 && ExportPakFileCopy::IsUnsupportedError(errno))
+				{
+					UE_LOG(LogExportPak, Verbose, TEXT("sendfile unavailable (errno %d), falling back to mapped writes."), errno);
+					bCanSendFile = false;
+				}
+				break;
+			}
+		}
+	}
+#endif
+
+	while (CopiedSize < Source.GetSize())
+	{
+		const int64 ChunkSize = FMath::Min(Source.GetSize() - CopiedSize, ExportPakFileCopy::MaxCopyChunkSize);
+		const ssize_t Result = pwrite(FileDescriptor, Source.GetData() + CopiedSize, (size_t)ChunkSize, DestOffset + CopiedSize);
+		if (Result > 0)
+		{
+			CopiedSize += Result;
+			OutMethod = EExportPakCopyMethod::MappedWrite;
+		}
+		else if (Result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		else
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Failed to write %lld bytes at offset %lld (errno %d)."), ChunkSize, DestOffset + CopiedSize, errno);
+			return false;
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,86 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** How the data of a raw pak entry got from the cooked file into the pak. */
+enum class EExportPakCopyMethod : uint8
+{
+	/** copy_file_range, the kernel copies or reflinks the range without it passing through user space. */
+	CopyFileRange,
+
+	/** sendfile from the cooked file to the pak, also in the kernel. */
+	SendFile,
+
+	/** pwrite straight from the mapped view of the cooked file. */
+	MappedWrite,
+};
+
+/**
+ * Read-only mapping of a whole cooked file. Hashing it reads the page cache in place instead of copying
+ * the file into a buffer first. Only POSIX platforms can map, Open() returns false everywhere else.
+ */
+class FExportPakMappedFile
+{
+public:
+	FExportPakMappedFile();
+
+	~FExportPakMappedFile();
+
+	/** Returns false if the platform cannot map files, the file cannot be opened or it is empty. */
+	bool Open(const FString& Filepath);
+
+	void Close();
+
+	const uint8* GetData() const
+	{
+		return Data;
+	}
+
+	int64 GetSize() const
+	{
+		return Size;
+	}
+
+private:
+	friend class FExportPakCopyTarget;
+
+	int32 FileDescriptor;
+
+	const uint8* Data;
+
+	int64 Size;
+};
+
+/**
+ * A second descriptor of the pak being written, so the data of mapped files can be copied into it with the
+ * fastest call the OS and the filesystems have, falling back to the next one the first time a call is refused.
+ */
+class FExportPakCopyTarget
+{
+public:
+	FExportPakCopyTarget();
+
+	~FExportPakCopyTarget();
+
+	/** Opens an existing file for writing. Returns false if the platform has no copy offload at all. */
+	bool Open(const FString& Filepath);
+
+	void Close();
+
+	bool IsOpen() const
+	{
+		return FileDescriptor >= 0;
+	}
+
+	/** Writes the whole source at DestOffset. Returns false on a write error, not when a method is unsupported. */
+	bool CopyFrom(const FExportPakMappedFile& Source, int64 DestOffset, EExportPakCopyMethod& OutMethod);
+
+private:
+	int32 FileDescriptor;
+
+	/** Cleared the first time the call fails as unsupported, e.g. across filesystems or on an old kernel. */
+	bool bCanCopyFileRange;
+	bool bCanSendFile;
+};
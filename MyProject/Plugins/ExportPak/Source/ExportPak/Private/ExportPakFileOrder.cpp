@@ -0,0 +1,215 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakFileOrder.h"
+#include "ExportPak.h"
+#include "ExportPakWriter.h"
+#include "FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/Parse.h"
+
+bool FExportPakFileOpenOrder::Load(const FString& Filepath)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Filepath))
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to read the file open order log %s"), *Filepath);
+		return false;
+	}
+
+	Parse(Lines);
+	if (Num() == 0)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("The file open order log %s lists no file."), *Filepath);
+		return false;
+	}
+
+	UE_LOG(LogExportPak, Log, TEXT("Laying out paks in the open order of %d file(s) from %s"), Num(), *Filepath);
+	return true;
+}
+
+void FExportPakFileOpenOrder::Parse(const TArray<FString>& Lines)
+{
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		const TCHAR* LinePtr = *Lines[LineIndex];
+
+		FString Path;
+		if (!FParse::Token(LinePtr, Path, false) || Path.IsEmpty())
+		{
+			continue;
+		}
+
+		FString OrderString;
+		const int32 Order = FParse::Token(LinePtr, OrderString, false) && OrderString.IsNumeric() ? FCString::Atoi(*OrderString) : LineIndex;
+
+		Path = NormalizePath(Path);
+		if (FileOrders.Contains(Path))
+		{
+			continue;
+		}
+		FileOrders.Add(Path, Order);
+
+		const FString PackagePath = FPaths::GetBaseFilename(Path, false);
+		if (int32* PackageOrder = PackageOrders.Find(PackagePath))
+		{
+			*PackageOrder = FMath::Min(*PackageOrder, Order);
+		}
+		else
+		{
+			PackageOrders.Add(PackagePath, Order);
+		}
+	}
+}
+
+FString FExportPakFileOpenOrder::NormalizePath(const FString& Path)
+{
+	return Path.Replace(TEXT("\\"), TEXT("/"));
+}
+
+bool FExportPakFileOpenOrder::GetOrder(const FString& DestFilepath, int32& OutOrder, int32& OutRank) const
+{
+	const FString Path = NormalizePath(DestFilepath);
+	if (const int32* FileOrder = FileOrders.Find(Path))
+	{
+		OutOrder = *FileOrder;
+		OutRank = 0;
+		return true;
+	}
+
+	if (const int32* PackageOrder = PackageOrders.Find(FPaths::GetBaseFilename(Path, false)))
+	{
+		OutOrder = *PackageOrder;
+		OutRank = 1;
+		return true;
+	}
+
+	return false;
+}
+
+namespace ExportPakFileOrder
+{
+	struct FSortKey
+	{
+		int32 Order;
+		int32 Rank;
+		int32 Index;
+
+		bool operator<(const FSortKey& Other) const
+		{
+			if (Order != Other.Order)
+			{
+				return Order < Other.Order;
+			}
+			if (Rank != Other.Rank)
+			{
+				return Rank < Other.Rank;
+			}
+			return Index < Other.Index;
+		}
+	};
+}
+
+int32 FExportPakFileOpenOrder::Sort(TArray<FExportPakFileEntry>& Files) const
+{
+	int32 NumOrderedFiles = 0;
+
+	TArray<ExportPakFileOrder::FSortKey> Keys;
+	Keys.SetNum(Files.Num());
+	for (int32 Index = 0; Index < Files.Num(); ++Index)
+	{
+		ExportPakFileOrder::FSortKey& Key = Keys[Index];
+		Key.Index = Index;
+		if (GetOrder(Files[Index].DestFilepath, Key.Order, Key.Rank))
+		{
+			++NumOrderedFiles;
+		}
+		else
+		{
+			Key.Order = MAX_int32;
+			Key.Rank = MAX_int32;
+		}
+	}
+
+	if (NumOrderedFiles == 0)
+	{
+		return 0;
+	}
+
+	// The index makes every key unique, so the unstable sort keeps the order of equal files.
+	Keys.Sort();
+
+	TArray<FExportPakFileEntry> SortedFiles;
+	SortedFiles.Reserve(Files.Num());
+	for (const auto& Key : Keys)
+	{
+		SortedFiles.Add(MoveTemp(Files[Key.Index]));
+	}
+	Files = MoveTemp(SortedFiles);
+
+	return NumOrderedFiles;
+}
+
+int32 FExportPakFileOpenOrder::CountSeeks(const TArray<FExportPakFileEntry>& Files) const
+{
+	// Index is the position of the file in the pak here.
+	TArray<ExportPakFileOrder::FSortKey> Reads;
+	for (int32 Index = 0; Index < Files.Num(); ++Index)
+	{
+		ExportPakFileOrder::FSortKey Read;
+		Read.Index = Index;
+		if (GetOrder(Files[Index].DestFilepath, Read.Order, Read.Rank))
+		{
+			Reads.Add(Read);
+		}
+	}
+	Reads.Sort();
+
+	int32 NumSeeks = 0;
+	for (int32 ReadIndex = 1; ReadIndex < Reads.Num(); ++ReadIndex)
+	{
+		if (Reads[ReadIndex].Index != Reads[ReadIndex - 1].Index + 1)
+		{
+			++NumSeeks;
+		}
+	}
+	return NumSeeks;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakFileOpenOrderTest, "ExportPak.FileOpenOrder", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakFileOpenOrderTest::RunTest(const FString& Parameters)
+{
+	FExportPakFileOpenOrder OpenOrder;
+	OpenOrder.Parse({
+		TEXT("\"../../../MyProject/Content/Maps/A.umap\" 1"),
+		TEXT("\"../../../MyProject/Content/Maps/A.uexp\" 2"),
+		TEXT("\"..\\..\\..\\MyProject\\Content\\Props\\C.uasset\" 3"),
+		TEXT("\"../../../MyProject/Content/Maps/A.umap\" 7"),
+		TEXT(""),
+		TEXT("\"../../../MyProject/Content/Props/B.uasset\""),
+	});
+	// B has no order number and takes its line index, 5.
+	TestEqual(TEXT("Duplicates and empty lines are skipped"), OpenOrder.Num(), 4);
+
+	TArray<FExportPakFileEntry> Files;
+	Files.Add(FExportPakFileEntry(TEXT("B.uasset"), TEXT("../../../MyProject/Content/Props/B.uasset")));
+	Files.Add(FExportPakFileEntry(TEXT("B.uexp"), TEXT("../../../MyProject/Content/Props/B.uexp")));
+	Files.Add(FExportPakFileEntry(TEXT("A.umap"), TEXT("../../../MyProject/Content/Maps/A.umap")));
+	Files.Add(FExportPakFileEntry(TEXT("A.uexp"), TEXT("../../../MyProject/Content/Maps/A.uexp")));
+	Files.Add(FExportPakFileEntry(TEXT("X.uasset"), TEXT("../../../MyProject/Content/Props/X.uasset")));
+	Files.Add(FExportPakFileEntry(TEXT("C.uasset"), TEXT("../../../MyProject/Content/Props/C.uasset")));
+	Files.Add(FExportPakFileEntry(TEXT("C.ubulk"), TEXT("../../../MyProject/Content/Props/C.ubulk")));
+
+	// A, C, B are read in that order: A -> C skips X, C -> B goes back.
+	TestEqual(TEXT("Seeks of the discovery order"), OpenOrder.CountSeeks(Files), 2);
+
+	TestEqual(TEXT("Files placed by the log"), OpenOrder.Sort(Files), 6);
+	const TCHAR* ExpectedOrder[] = { TEXT("A.umap"), TEXT("A.uexp"), TEXT("C.uasset"), TEXT("C.ubulk"), TEXT("B.uasset"), TEXT("B.uexp"), TEXT("X.uasset") };
+	for (int32 Index = 0; Index < Files.Num(); ++Index)
+	{
+		TestEqual(TEXT("Sorted by open order"), Files[Index].SourceFilepath, FString(ExpectedOrder[Index]));
+	}
+	TestEqual(TEXT("Seeks of the open order"), OpenOrder.CountSeeks(Files), 0);
+
+	return true;
+}
@@ -0,0 +1,50 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FExportPakFileEntry;
+
+/**
+ * The order a playtest opened the cooked files in, read from the log a -fileopenlog run writes (GameOpenOrder.log):
+ * one "<path inside the pak>" <open order> per line. Laying the files of a pak out in that order makes the reads
+ * of a load near sequential, which is what matters on HDDs and optical media.
+ */
+class FExportPakFileOpenOrder
+{
+public:
+	/** Logs and returns false if the file cannot be read or lists no file. */
+	bool Load(const FString& Filepath);
+
+	/** Adds the lines of a log. A line without an order number takes its line index, a path seen before keeps its first order. */
+	void Parse(const TArray<FString>& Lines);
+
+	int32 Num() const
+	{
+		return FileOrders.Num();
+	}
+
+	/**
+	 * Stable sort of the files by open order. A file the log does not list but whose package it does, e.g. a .ubulk,
+	 * goes right after the first opened file of its package. The remaining files keep their order at the end.
+	 * Returns how many files were placed by the log.
+	 */
+	int32 Sort(TArray<FExportPakFileEntry>& Files) const;
+
+	/** Seeks to read the files of the log in open order: every read that does not start where the previous one ended. */
+	int32 CountSeeks(const TArray<FExportPakFileEntry>& Files) const;
+
+private:
+	/** False if neither the file nor its package is in the log. Rank puts the logged file before the rest of its package. */
+	bool GetOrder(const FString& DestFilepath, int32& OutOrder, int32& OutRank) const;
+
+	static FString NormalizePath(const FString& Path);
+
+private:
+	/** Path inside the pak -> open order, the TMap keys ignore case like UnrealPak does. */
+	TMap<FString, int32> FileOrders;
+
+	/** Path without extension -> the lowest open order of the files of the package. */
+	TMap<FString, int32> PackageOrders;
+};
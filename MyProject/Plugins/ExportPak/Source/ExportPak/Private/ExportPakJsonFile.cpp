@@ -0,0 +1,87 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakJsonFile.h"
+#include "ExportPak.h"
+#include "FileManager.h"
+
+namespace ExportPakJsonFile
+{
+	/** Characters encoded and written at once. */
+	static const int32 FlushThreshold = 64 * 1024;
+}
+
+FExportPakJsonFileArchive::FExportPakJsonFileArchive(const FString& InFilepath)
+	:
+	Filepath(InFilepath)
+{
+	ArIsSaving = true;
+
+	FileArchive.Reset(IFileManager::Get().CreateFileWriter(*Filepath));
+	if (!FileArchive)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to create %s"), *Filepath);
+		ArIsError = true;
+	}
+
+	PendingChars.Reserve(ExportPakJsonFile::FlushThreshold + 1);
+}
+
+FExportPakJsonFileArchive::~FExportPakJsonFileArchive()
+{
+	Close();
+}
+
+void FExportPakJsonFileArchive::Serialize(void* Data, int64 Num)
+{
+	// TJsonWriter<TCHAR> only ever writes whole characters.
+	check(Num % sizeof(TCHAR) == 0);
+
+	PendingChars.Append(static_cast<const TCHAR*>(Data), Num / sizeof(TCHAR));
+	if (PendingChars.Num() >= ExportPakJsonFile::FlushThreshold)
+	{
+		Flush(false);
+	}
+}
+
+void FExportPakJsonFileArchive::Flush(bool bFinal)
+{
+	if (!FileArchive || PendingChars.Num() == 0)
+	{
+		return;
+	}
+
+	// With UTF-16 TCHARs a surrogate pair may arrive in two writes, it has to be encoded as one code point.
+	int32 NumCharsToEncode = PendingChars.Num();
+	if (!bFinal && sizeof(TCHAR) == 2 && (PendingChars.Last() & 0xFC00) == 0xD800)
+	{
+		--NumCharsToEncode;
+	}
+
+	const int32 ConvertedLength = FTCHARToUTF8_Convert::ConvertedLength(PendingChars.GetData(), NumCharsToEncode);
+	Utf8Buffer.SetNumUninitialized(ConvertedLength, false);
+	FTCHARToUTF8_Convert::Convert(Utf8Buffer.GetData(), ConvertedLength, PendingChars.GetData(), NumCharsToEncode);
+	FileArchive->Serialize(Utf8Buffer.GetData(), ConvertedLength);
+
+	PendingChars.RemoveAt(0, NumCharsToEncode, false);
+}
+
+bool FExportPakJsonFileArchive::Close()
+{
+	if (!FileArchive)
+	{
+		return false;
+	}
+
+	Flush(true);
+
+	const bool bSuccess = FileArchive->Close() && !FileArchive->IsError() && !ArIsError;
+	FileArchive.Reset();
+
+	if (!bSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to write %s"), *Filepath);
+		IFileManager::Get().Delete(*Filepath);
+	}
+
+	return bSuccess;
+}
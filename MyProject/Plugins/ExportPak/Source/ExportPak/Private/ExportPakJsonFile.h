@@ -0,0 +1,54 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/Archive.h"
+#include "Templates/UniquePtr.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+
+/**
+ * An archive a TJsonWriter<TCHAR> streams into, that saves the text to a file as UTF-8 without BOM.
+ * The text is encoded a chunk at a time through reused buffers, so the document is never held as a whole,
+ * neither as a DOM nor as one FString.
+ */
+class FExportPakJsonFileArchive : public FArchive
+{
+public:
+	/** Creates the file and its directory, IsOpen() tells whether that worked. */
+	explicit FExportPakJsonFileArchive(const FString& InFilepath);
+
+	virtual ~FExportPakJsonFileArchive();
+
+	bool IsOpen() const
+	{
+		return FileArchive.IsValid();
+	}
+
+	/** Writes what is left and closes the file. Logs and deletes the file if anything failed. */
+	virtual bool Close() override;
+
+	virtual void Serialize(void* Data, int64 Num) override;
+
+	virtual FString GetArchiveName() const override
+	{
+		return Filepath;
+	}
+
+private:
+	/** Encode the pending text. A trailing high surrogate waits for its pair unless bFinal. */
+	void Flush(bool bFinal);
+
+private:
+	FString Filepath;
+
+	TUniquePtr<FArchive> FileArchive;
+
+	TArray<TCHAR> PendingChars;
+
+	TArray<ANSICHAR> Utf8Buffer;
+};
+
+/** Same output as FJsonSerializer::Serialize with TJsonWriterFactory<>::Create(&String). */
+typedef TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>> FExportPakJsonWriter;
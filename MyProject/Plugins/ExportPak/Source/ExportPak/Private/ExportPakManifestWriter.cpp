@@ -0,0 +1,233 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakManifestWriter.h"
+#include "ExportPakManifest.h"
+#include "ExportPak.h"
+#include "Misc/FileHelper.h"
+
+namespace ExportPakManifestWriter
+{
+	/** Interns UTF-8 strings, offset 0 is the empty string. */
+	class FStringTable
+	{
+	public:
+		FStringTable()
+		{
+			Data.Add(0);
+			Offsets.Add(FString(), 0);
+		}
+
+		uint32 Add(const FString& String)
+		{
+			if (const uint32* Offset = Offsets.Find(String))
+			{
+				return *Offset;
+			}
+
+			const uint32 Offset = Data.Num();
+			FTCHARToUTF8 Utf8String(*String);
+			Data.Append(reinterpret_cast<const uint8*>(Utf8String.Get()), Utf8String.Length());
+			Data.Add(0);
+
+			Offsets.Add(String, Offset);
+			return Offset;
+		}
+
+		TArray<uint8> Data;
+
+	private:
+		TMap<FString, uint32> Offsets;
+	};
+
+	/** Appends a section at the next 8 byte boundary and returns its offset. */
+	uint64 AppendSection(TArray<uint8>& OutData, const void* SectionData, int64 SectionSize)
+	{
+		OutData.AddZeroed(Align(OutData.Num(), 8) - OutData.Num());
+
+		const uint64 Offset = OutData.Num();
+		OutData.Append(static_cast<const uint8*>(SectionData), SectionSize);
+		return Offset;
+	}
+}
+
+void FExportPakManifestWriter::Build(const TMap<FString, FDependenciesInfo>& DependenciesInfos, TArray<uint8>& OutData, EExportPakNameHash NameHash)
+{
+	ExportPakManifestWriter::FStringTable Strings;
+
+	// Packages are first numbered in the order they are met, then sorted by hash and renumbered.
+	TArray<FExportPakManifestPackage> Packages;
+	TMap<FString, int32> PackageIndices;
+	auto FindOrAddPackage = [&Packages, &PackageIndices, &Strings, NameHash](const FString& PackageName) -> int32
+	{
+		if (const int32* PackageIndex = PackageIndices.Find(PackageName))
+		{
+			return *PackageIndex;
+		}
+
+		FExportPakManifestPackage& Package = Packages[Packages.AddZeroed()];
+		const FSHAHash Hash = FExportPakManifest::HashPackageName(PackageName, NameHash);
+		FMemory::Memcpy(Package.Hash, Hash.Hash, sizeof(Package.Hash));
+		Package.Name = Strings.Add(PackageName);
+		Package.RootIndex = INDEX_NONE;
+
+		return PackageIndices.Add(PackageName, Packages.Num() - 1);
+	};
+
+	TArray<FExportPakManifestRoot> Roots;
+	TArray<uint32> Edges;
+	for (const auto& DependenciesInfoEntry : DependenciesInfos)
+	{
+		const int32 RootPackageIndex = FindOrAddPackage(DependenciesInfoEntry.Key);
+		Packages[RootPackageIndex].AssetClass = Strings.Add(DependenciesInfoEntry.Value.AssetClassString);
+		Packages[RootPackageIndex].RootIndex = Roots.Num();
+
+		FExportPakManifestRoot& Root = Roots[Roots.AddZeroed()];
+		Root.Package = RootPackageIndex;
+		Root.FirstEdge = Edges.Num();
+		Root.NumDependenciesInGameContentDir = DependenciesInfoEntry.Value.DependenciesInGameContentDir.Num();
+		Root.NumOtherDependencies = DependenciesInfoEntry.Value.OtherDependencies.Num();
+
+		for (const auto& Dependency : DependenciesInfoEntry.Value.DependenciesInGameContentDir)
+		{
+			Edges.Add(FindOrAddPackage(Dependency));
+		}
+		for (const auto& Dependency : DependenciesInfoEntry.Value.OtherDependencies)
+		{
+			Edges.Add(FindOrAddPackage(Dependency));
+		}
+	}
+
+	TArray<int32> SortedPackages;
+	for (int32 PackageIndex = 0; PackageIndex < Packages.Num(); ++PackageIndex)
+	{
+		SortedPackages.Add(PackageIndex);
+	}
+	SortedPackages.Sort([&Packages](int32 A, int32 B)
+	{
+		return FMemory::Memcmp(Packages[A].Hash, Packages[B].Hash, sizeof(Packages[A].Hash)) < 0;
+	});
+
+	TArray<uint32> NewPackageIndices;
+	NewPackageIndices.SetNum(Packages.Num());
+	TArray<FExportPakManifestPackage> SortedPackageRecords;
+	for (int32 NewPackageIndex = 0; NewPackageIndex < SortedPackages.Num(); ++NewPackageIndex)
+	{
+		NewPackageIndices[SortedPackages[NewPackageIndex]] = NewPackageIndex;
+		SortedPackageRecords.Add(Packages[SortedPackages[NewPackageIndex]]);
+	}
+
+	for (auto& Root : Roots)
+	{
+		Root.Package = NewPackageIndices[Root.Package];
+	}
+	for (auto& Edge : Edges)
+	{
+		Edge = NewPackageIndices[Edge];
+	}
+
+	FExportPakManifestHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = ExportPakManifest::Magic;
+	Header.Version = ExportPakManifest::Version;
+	Header.NumPackages = SortedPackageRecords.Num();
+	Header.NumRoots = Roots.Num();
+	Header.NumEdges = Edges.Num();
+	Header.StringDataSize = Strings.Data.Num();
+	Header.NameHash = (uint32)NameHash;
+
+	// The header is written again once the offsets are known.
+	OutData.Reset();
+	ExportPakManifestWriter::AppendSection(OutData, &Header, sizeof(Header));
+	Header.PackagesOffset = ExportPakManifestWriter::AppendSection(OutData, SortedPackageRecords.GetData(), SortedPackageRecords.Num() * sizeof(FExportPakManifestPackage));
+	Header.RootsOffset = ExportPakManifestWriter::AppendSection(OutData, Roots.GetData(), Roots.Num() * sizeof(FExportPakManifestRoot));
+	Header.EdgesOffset = ExportPakManifestWriter::AppendSection(OutData, Edges.GetData(), Edges.Num() * sizeof(uint32));
+	Header.StringDataOffset = ExportPakManifestWriter::AppendSection(OutData, Strings.Data.GetData(), Strings.Data.Num());
+	FMemory::Memcpy(OutData.GetData(), &Header, sizeof(Header));
+}
+
+bool FExportPakManifestWriter::Save(const FString& Filepath, const TMap<FString, FDependenciesInfo>& DependenciesInfos, EExportPakNameHash NameHash)
+{
+	TArray<uint8> Data;
+	Build(DependenciesInfos, Data, NameHash);
+
+	bool bSaveSuccess = FFileHelper::SaveArrayToFile(Data, *Filepath);
+	if (!bSaveSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to save dependency manifest %s"), *Filepath);
+	}
+
+	return bSaveSuccess;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakManifestTest, "ExportPak.Manifest", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakManifestTest::RunTest(const FString& Parameters)
+{
+	TMap<FString, FDependenciesInfo> DependenciesInfos;
+	{
+		FDependenciesInfo& MapA = DependenciesInfos.Add(TEXT("/Game/Maps/MapA"));
+		MapA.AssetClassString = TEXT("World");
+		MapA.DependenciesInGameContentDir = { TEXT("/Game/Meshes/Rock"), TEXT("/Game/Textures/Rock_D") };
+		MapA.OtherDependencies = { TEXT("/Script/Engine") };
+
+		// A root may be a dependency of another root, and names do not have to be ASCII.
+		FDependenciesInfo& MapB = DependenciesInfos.Add(TEXT("/Game/Maps/MapB"));
+		MapB.AssetClassString = TEXT("World");
+		MapB.DependenciesInGameContentDir = { TEXT("/Game/Meshes/Rock"), TEXT("/Game/Maps/MapA"), TEXT("/Game/Textures/\u77F3") };
+	}
+
+	TArray<uint8> Data;
+	FExportPakManifestWriter::Build(DependenciesInfos, Data);
+
+	FExportPakManifest Manifest;
+	TestTrue(TEXT("Manifest is valid"), Manifest.Initialize(Data.GetData(), Data.Num()));
+	TestEqual(TEXT("Packages"), Manifest.GetNumPackages(), 6);
+	TestEqual(TEXT("Roots"), Manifest.GetNumRoots(), 2);
+
+	for (int32 PackageIndex = 1; PackageIndex < Manifest.GetNumPackages(); ++PackageIndex)
+	{
+		TestTrue(TEXT("Packages are sorted by hash"), FMemory::Memcmp(Manifest.GetPackageHash(PackageIndex - 1).Hash, Manifest.GetPackageHash(PackageIndex).Hash, 20) < 0);
+	}
+
+	for (const auto& DependenciesInfoEntry : DependenciesInfos)
+	{
+		const int32 RootPackage = Manifest.FindPackage(DependenciesInfoEntry.Key);
+		TestTrue(TEXT("Root is found"), RootPackage != INDEX_NONE && Manifest.IsRoot(RootPackage));
+		TestEqual(TEXT("Root name"), Manifest.GetPackageName(RootPackage), DependenciesInfoEntry.Key);
+		TestEqual(TEXT("Asset class"), Manifest.GetAssetClass(RootPackage), DependenciesInfoEntry.Value.AssetClassString);
+		TestEqual(TEXT("Dependencies"), Manifest.GetDependencies(RootPackage).Num(), DependenciesInfoEntry.Value.DependenciesInGameContentDir.Num() + DependenciesInfoEntry.Value.OtherDependencies.Num());
+
+		TArray<FString> ExpectedPaks;
+		ExpectedPaks.Add(HashStringWithSHA1(DependenciesInfoEntry.Key) + TEXT(".pak"));
+		for (const auto& Dependency : DependenciesInfoEntry.Value.DependenciesInGameContentDir)
+		{
+			ExpectedPaks.Add(HashStringWithSHA1(Dependency) + TEXT(".pak"));
+		}
+
+		TArray<FString> Paks;
+		TestTrue(TEXT("Dependency paks of a root"), Manifest.GetDependencyPaks(DependenciesInfoEntry.Key, Paks));
+		TestTrue(TEXT("Paks are the ones the exporter names"), Paks == ExpectedPaks);
+	}
+
+	const int32 DependencyPackage = Manifest.FindPackage(TEXT("/Game/Textures/\u77F3"));
+	TestTrue(TEXT("Non ASCII name round-trips"), DependencyPackage != INDEX_NONE && Manifest.GetPackageName(DependencyPackage) == TEXT("/Game/Textures/\u77F3"));
+	TestFalse(TEXT("A dependency is not a root"), DependencyPackage != INDEX_NONE && Manifest.IsRoot(DependencyPackage));
+	TestEqual(TEXT("Unknown package"), Manifest.FindPackage(TEXT("/Game/Unknown")), (int32)INDEX_NONE);
+
+	TArray<FString> Paks;
+	TestFalse(TEXT("No paks for a package that is not a root"), Manifest.GetDependencyPaks(TEXT("/Game/Meshes/Rock"), Paks));
+
+	// Paks named the legacy way are found by the legacy hash, the manifest records which one it was built with.
+	TArray<uint8> LegacyData;
+	FExportPakManifestWriter::Build(DependenciesInfos, LegacyData, EExportPakNameHash::LegacyAnsi);
+
+	FExportPakManifest LegacyManifest;
+	TestTrue(TEXT("Legacy manifest is valid"), LegacyManifest.Initialize(LegacyData.GetData(), LegacyData.Num()));
+	const int32 LegacyPackage = LegacyManifest.FindPackage(TEXT("/Game/Textures/\u77F3"));
+	TestTrue(TEXT("Legacy manifest finds packages by the legacy hash"), LegacyPackage != INDEX_NONE && LegacyManifest.GetPackageHash(LegacyPackage) == FExportPakManifest::HashPackageName(TEXT("/Game/Textures/\u77F3"), EExportPakNameHash::LegacyAnsi));
+
+	FExportPakManifest TruncatedManifest;
+	TestFalse(TEXT("Truncated manifest is rejected"), TruncatedManifest.Initialize(Data.GetData(), Data.Num() - 1));
+
+	return true;
+}
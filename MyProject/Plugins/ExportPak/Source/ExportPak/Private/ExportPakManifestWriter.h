@@ -0,0 +1,17 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ExportPakExporter.h"
+#include "ExportPakManifest.h"
+
+/** Builds AssetDependencies.bin from the gathered dependencies, FExportPakManifestHeader describes the layout. */
+class FExportPakManifestWriter
+{
+public:
+	/** NameHash must be the one the paks were named with, the reader finds packages by it. */
+	static void Build(const TMap<FString, FDependenciesInfo>& DependenciesInfos, TArray<uint8>& OutData, EExportPakNameHash NameHash = EExportPakNameHash::Utf8);
+
+	static bool Save(const FString& Filepath, const TMap<FString, FDependenciesInfo>& DependenciesInfos, EExportPakNameHash NameHash = EExportPakNameHash::Utf8);
+};
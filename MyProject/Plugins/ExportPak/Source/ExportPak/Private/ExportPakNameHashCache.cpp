@@ -0,0 +1,111 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakNameHashCache.h"
+#include "ExportPak.h"
+#include "ExportPakExporter.h"
+#include "Async/ParallelFor.h"
+
+FExportPakNameHashCache::FExportPakNameHashCache(EExportPakNameHash InNameHash)
+	:
+	NameHash(InNameHash)
+{
+}
+
+FExportPakNameHashCache& FExportPakNameHashCache::Get(EExportPakNameHash NameHash)
+{
+	static FExportPakNameHashCache Utf8Cache(EExportPakNameHash::Utf8);
+	static FExportPakNameHashCache LegacyAnsiCache(EExportPakNameHash::LegacyAnsi);
+
+	return NameHash == EExportPakNameHash::LegacyAnsi ? LegacyAnsiCache : Utf8Cache;
+}
+
+FSHAHash FExportPakNameHashCache::Hash(const FString& LongPackageName)
+{
+	FShard& Shard = Shards[FCaseSensitiveKeyFuncs::GetKeyHash(LongPackageName) % NumShards];
+
+	FSHAHash Result;
+	Shard.Lock.ReadLock();
+	const FSHAHash* CachedHash = Shard.Hashes.Find(LongPackageName);
+	const bool bFound = CachedHash != nullptr;
+	if (bFound)
+	{
+		Result = *CachedHash;
+	}
+	Shard.Lock.ReadUnlock();
+
+	if (bFound)
+	{
+		return Result;
+	}
+
+	// Hashed outside of the lock. Two workers may hash the same name at once, they get the same result.
+	Result = FExportPakManifest::HashPackageName(LongPackageName, NameHash);
+
+	Shard.Lock.WriteLock();
+	Shard.Hashes.Add(LongPackageName, Result);
+	Shard.Lock.WriteUnlock();
+
+	return Result;
+}
+
+int32 FExportPakNameHashCache::Num() const
+{
+	int32 NumNames = 0;
+	for (const FShard& Shard : Shards)
+	{
+		Shard.Lock.ReadLock();
+		NumNames += Shard.Hashes.Num();
+		Shard.Lock.ReadUnlock();
+	}
+	return NumNames;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakNameHashCacheTest, "ExportPak.NameHashCache", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakNameHashCacheTest::RunTest(const FString& Parameters)
+{
+	// ASCII names hash the same either way, so existing pak names do not change.
+	const FString AsciiName = TEXT("/Game/MyProject/Maps/MyTestMap");
+	TestEqual(TEXT("ASCII name, UTF-8"), HashStringWithSHA1(AsciiName, EExportPakNameHash::Utf8).ToLower(), FString(TEXT("eb397865ca4d6f2d48fb44a45424cff0fe60541e")));
+	TestEqual(TEXT("ASCII name, legacy"), HashStringWithSHA1(AsciiName, EExportPakNameHash::LegacyAnsi).ToLower(), FString(TEXT("eb397865ca4d6f2d48fb44a45424cff0fe60541e")));
+
+	// The legacy hash folds every non-ASCII character to '?', so different names collide.
+	const FString StoneName = TEXT("/Game/Textures/\u77F3");
+	const FString TreeName = TEXT("/Game/Textures/\u6728");
+	TestEqual(TEXT("Legacy hash is the one of the ANSI conversion"), HashStringWithSHA1(StoneName, EExportPakNameHash::LegacyAnsi), HashStringWithSHA1(TEXT("/Game/Textures/?"), EExportPakNameHash::LegacyAnsi));
+	TestEqual(TEXT("Legacy hashes collide"), HashStringWithSHA1(StoneName, EExportPakNameHash::LegacyAnsi), HashStringWithSHA1(TreeName, EExportPakNameHash::LegacyAnsi));
+	TestNotEqual(TEXT("UTF-8 hashes do not"), HashStringWithSHA1(StoneName, EExportPakNameHash::Utf8), HashStringWithSHA1(TreeName, EExportPakNameHash::Utf8));
+
+	FSHAHash Utf8Hash;
+	FSHA1::HashBuffer("/Game/Textures/\xE7\x9F\xB3", 18, Utf8Hash.Hash);
+	TestEqual(TEXT("UTF-8 hash is the one of the UTF-8 bytes"), HashStringWithSHA1(StoneName, EExportPakNameHash::Utf8), Utf8Hash.ToString());
+
+	// Workers hashing the same names at once all get the uncached result.
+	TArray<FString> Names;
+	TArray<FString> ExpectedHashes;
+	for (int32 NameIndex = 0; NameIndex < 1000; ++NameIndex)
+	{
+		Names.Add(FString::Printf(TEXT("/Game/NameHashCacheTest/Package%d"), NameIndex));
+		ExpectedHashes.Add(FExportPakManifest::HashPackageName(Names.Last()).ToString());
+	}
+
+	FExportPakNameHashCache Cache(EExportPakNameHash::Utf8);
+	TArray<FString> Hashes;
+	Hashes.SetNum(Names.Num() * 8);
+	ParallelFor(Hashes.Num(), [&Cache, &Names, &Hashes](int32 Index)
+	{
+		Hashes[Index] = Cache.Hash(Names[Index % Names.Num()]).ToString();
+	});
+
+	bool bAllMatch = true;
+	for (int32 Index = 0; Index < Hashes.Num(); ++Index)
+	{
+		bAllMatch &= Hashes[Index] == ExpectedHashes[Index % Names.Num()];
+	}
+	TestTrue(TEXT("Concurrent lookups match"), bAllMatch);
+	TestEqual(TEXT("Each name cached once"), Cache.Num(), Names.Num());
+
+	TestNotEqual(TEXT("Names differing in case only have their own hashes"), Cache.Hash(TEXT("/Game/NameHashCacheTest/PACKAGE0")).ToString(), ExpectedHashes[0]);
+
+	return true;
+}
@@ -0,0 +1,56 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "ExportPakManifest.h"
+
+/**
+ * Long package name to the SHA1 its paks are named with, computed once per name and process.
+ * A root asks for the hashes of its whole closure several times (pak, response and log files, description file),
+ * and roots share most of their dependencies.
+ * Names are spread over shards with a read/write lock each, so the root and pak workers only take uncontended
+ * read locks once the names are known.
+ */
+class FExportPakNameHashCache
+{
+public:
+	explicit FExportPakNameHashCache(EExportPakNameHash InNameHash);
+
+	/** Process-wide cache of a hashing mode. */
+	static FExportPakNameHashCache& Get(EExportPakNameHash NameHash);
+
+	/** FExportPakManifest::HashPackageName(). Thread-safe, a cached lookup copies 20 bytes and does not allocate. */
+	FSHAHash Hash(const FString& LongPackageName);
+
+	/** Number of names cached so far. */
+	int32 Num() const;
+
+private:
+	/** FString keys of a TMap ignore case, the hash of a name does not. */
+	struct FCaseSensitiveKeyFuncs : TDefaultMapKeyFuncs<FString, FSHAHash, false>
+	{
+		static bool Matches(const FString& A, const FString& B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+
+		static uint32 GetKeyHash(const FString& Key)
+		{
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+
+	struct FShard
+	{
+		mutable FRWLock Lock;
+		TMap<FString, FSHAHash, FDefaultSetAllocator, FCaseSensitiveKeyFuncs> Hashes;
+	};
+
+	static const int32 NumShards = 64;
+
+	EExportPakNameHash NameHash;
+
+	FShard Shards[NumShards];
+};
@@ -0,0 +1,53 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakParallel.h"
+#include "ExportPakProcessPool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/PlatformProcess.h"
+
+void ExportPakParallelFor(int32 Num, int32 MaxWorkers, EAsyncExecution Execution, TFunctionRef<void(int32)> Body, TFunctionRef<void(int32)> OnProgress)
+{
+	if (Num <= 0)
+	{
+		return;
+	}
+
+	const int32 NumWorkers = FMath::Min(Num, MaxWorkers > 0 ? MaxWorkers : FExportPakProcessPool::GetDefaultMaxProcesses());
+
+	FThreadSafeCounter NextIndex;
+	FThreadSafeCounter NumFinished;
+
+	TArray<TFuture<void>> Workers;
+	for (int32 WorkerIndex = 0; WorkerIndex < NumWorkers; ++WorkerIndex)
+	{
+		Workers.Add(Async<void>(Execution, [Num, &Body, &NextIndex, &NumFinished]()
+		{
+			for (int32 Index = NextIndex.Increment() - 1; Index < Num; Index = NextIndex.Increment() - 1)
+			{
+				Body(Index);
+				NumFinished.Increment();
+			}
+		}));
+	}
+
+	// Progress can only be reported from this thread, so poll the workers.
+	int32 NumReported = 0;
+	while (NumReported < Num)
+	{
+		const int32 NumFinishedNow = NumFinished.GetValue();
+		if (NumFinishedNow > NumReported)
+		{
+			NumReported = NumFinishedNow;
+			OnProgress(NumReported);
+		}
+		else
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+	}
+
+	for (auto& Worker : Workers)
+	{
+		Worker.Wait();
+	}
+}
@@ -0,0 +1,107 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Async.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+
+/**
+ * Run Body(Index) for every Index in [0, Num) on at most MaxWorkers workers, and block until all of them are done.
+ *
+ * @param MaxWorkers	<= 0 means one worker per logical core.
+ * @param Execution		Use EAsyncExecution::Thread for work that itself waits on the thread pool, to avoid starving it.
+ * @param OnProgress	Called on the calling thread with the number of finished items whenever it grows,
+ *						so it may drive a FScopedSlowTask.
+ */
+void ExportPakParallelFor(int32 Num, int32 MaxWorkers, EAsyncExecution Execution, TFunctionRef<void(int32)> Body, TFunctionRef<void(int32)> OnProgress);
+
+/**
+ * FIFO of at most Capacity items between producer and consumer threads.
+ * Like ExportPakParallelFor it waits by polling, which is plenty for items that each take milliseconds or more.
+ */
+template <typename ItemType>
+class TExportPakBoundedQueue
+{
+public:
+	explicit TExportPakBoundedQueue(int32 InCapacity)
+		:
+		Capacity(FMath::Max(InCapacity, 1)),
+		bClosed(false)
+	{
+	}
+
+	/** Adds the item unless the queue is full or closed. */
+	bool TryPush(const ItemType& Item)
+	{
+		FScopeLock ItemsLock(&ItemsCritical);
+		if (bClosed || Items.Num() >= Capacity)
+		{
+			return false;
+		}
+
+		Items.Add(Item);
+		return true;
+	}
+
+	/** Waits while the queue is full. Returns false if it is closed, the item is dropped then. */
+	bool Push(const ItemType& Item)
+	{
+		while (!TryPush(Item))
+		{
+			if (IsClosed())
+			{
+				return false;
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return true;
+	}
+
+	/** Waits while the queue is empty and open. Returns false once it is closed and every item was popped. */
+	bool Pop(ItemType& OutItem)
+	{
+		for (;;)
+		{
+			{
+				FScopeLock ItemsLock(&ItemsCritical);
+				if (Items.Num() > 0)
+				{
+					OutItem = MoveTemp(Items[0]);
+					Items.RemoveAt(0, 1, false);
+					return true;
+				}
+
+				if (bClosed)
+				{
+					return false;
+				}
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+	}
+
+	/** No item is added any more, consumers still get the queued ones. */
+	void Close()
+	{
+		FScopeLock ItemsLock(&ItemsCritical);
+		bClosed = true;
+	}
+
+	bool IsClosed() const
+	{
+		FScopeLock ItemsLock(&ItemsCritical);
+		return bClosed;
+	}
+
+private:
+	const int32 Capacity;
+
+	bool bClosed;
+
+	TArray<ItemType> Items;
+
+	mutable FCriticalSection ItemsCritical;
+};
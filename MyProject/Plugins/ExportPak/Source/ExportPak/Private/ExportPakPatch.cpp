@@ -0,0 +1,138 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakPatch.h"
+#include "ExportPak.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "json.h"
+
+FString FExportPakPatch::GetBaselineDescriptionFilepath(const FString& BaselineDirectory, const FString& CookedPlatformName, const FString& HashedRootName)
+{
+	return FPaths::Combine(BaselineDirectory, CookedPlatformName, HashedRootName, HashedRootName + TEXT(".json"));
+}
+
+bool FExportPakPatch::LoadBaselineCookedFiles(const FString& DescriptionFilepath, TMap<FString, FString>& OutHashes)
+{
+	OutHashes.Empty();
+
+	FString DescriptionString;
+	if (!FFileHelper::LoadFileToString(DescriptionString, *DescriptionFilepath))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootJsonObject;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(DescriptionString), RootJsonObject) || !RootJsonObject.IsValid())
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to parse baseline description file %s"), *DescriptionFilepath);
+		return false;
+	}
+
+	// Exports older than cooked_files, or made without bRecordCookedFileHashes, cannot be diffed.
+	const TArray<TSharedPtr<FJsonValue>>* CookedFilesJson = nullptr;
+	if (!RootJsonObject->TryGetArrayField(TEXT("cooked_files"), CookedFilesJson))
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Baseline description file %s has no cooked_files, export the baseline with bRecordCookedFileHashes."), *DescriptionFilepath);
+		return false;
+	}
+
+	for (const auto& CookedFileJson : *CookedFilesJson)
+	{
+		const TSharedPtr<FJsonObject>* CookedFileJsonObject = nullptr;
+		if (!CookedFileJson->TryGetObject(CookedFileJsonObject))
+		{
+			continue;
+		}
+
+		FString Path;
+		FString Hash;
+		if ((*CookedFileJsonObject)->TryGetStringField(TEXT("path"), Path) && (*CookedFileJsonObject)->TryGetStringField(TEXT("sha1"), Hash))
+		{
+			OutHashes.Add(Path, Hash);
+		}
+	}
+
+	return true;
+}
+
+void FExportPakPatch::Diff(const TMap<FString, FString>& BaselineHashes, const TArray<FExportPakCookedFileRecord>& CurrentFiles, FExportPakPatchDiff& OutDiff)
+{
+	OutDiff = FExportPakPatchDiff();
+
+	TSet<FString> CurrentPaths;
+	for (int32 FileIndex = 0; FileIndex < CurrentFiles.Num(); ++FileIndex)
+	{
+		const FExportPakCookedFileRecord& File = CurrentFiles[FileIndex];
+		CurrentPaths.Add(File.DestFilepath);
+
+		const FString* BaselineHash = BaselineHashes.Find(File.DestFilepath);
+		if (BaselineHash == nullptr)
+		{
+			OutDiff.AddedFiles.Add(FileIndex);
+		}
+		else if (*BaselineHash != File.Hash)
+		{
+			OutDiff.ChangedFiles.Add(FileIndex);
+		}
+	}
+
+	for (const auto& BaselineEntry : BaselineHashes)
+	{
+		if (!CurrentPaths.Contains(BaselineEntry.Key))
+		{
+			OutDiff.DeletedFiles.Add(BaselineEntry.Key);
+		}
+	}
+	OutDiff.DeletedFiles.Sort();
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakPatchDiffTest, "ExportPak.Patch.Diff", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakPatchDiffTest::RunTest(const FString& Parameters)
+{
+	FString TestDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/PatchDiffTest")));
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	const FString BaselineFilepath = FExportPakPatch::GetBaselineDescriptionFilepath(TestDirectory, TEXT("WindowsNoEditor"), TEXT("ABCD"));
+	FFileHelper::SaveStringToFile(TEXT("{ \"long_package_name\": \"/Game/Root\", \"cooked_files\": [")
+		TEXT("{ \"path\": \"../../../MyProject/Content/Root.uasset\", \"size\": \"10\", \"sha1\": \"AAAA\" },")
+		TEXT("{ \"path\": \"../../../MyProject/Content/Texture.ubulk\", \"size\": \"20\", \"sha1\": \"BBBB\" },")
+		TEXT("{ \"path\": \"../../../MyProject/Content/Removed.uasset\", \"size\": \"30\", \"sha1\": \"CCCC\" } ] }"),
+		*BaselineFilepath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+
+	TMap<FString, FString> BaselineHashes;
+	TestTrue(TEXT("Baseline loaded"), FExportPakPatch::LoadBaselineCookedFiles(BaselineFilepath, BaselineHashes));
+	TestEqual(TEXT("Baseline files"), BaselineHashes.Num(), 3);
+
+	TArray<FExportPakCookedFileRecord> CurrentFiles;
+	const TCHAR* CurrentPaths[] = { TEXT("../../../MyProject/Content/Root.uasset"), TEXT("../../../MyProject/Content/Texture.ubulk"), TEXT("../../../MyProject/Content/Added.uasset") };
+	const TCHAR* CurrentHashes[] = { TEXT("AAAA"), TEXT("B2B2"), TEXT("DDDD") };
+	for (int32 Index = 0; Index < ARRAY_COUNT(CurrentPaths); ++Index)
+	{
+		FExportPakCookedFileRecord& Record = CurrentFiles[CurrentFiles.AddDefaulted()];
+		Record.DestFilepath = CurrentPaths[Index];
+		Record.Hash = CurrentHashes[Index];
+	}
+
+	FExportPakPatchDiff Diff;
+	FExportPakPatch::Diff(BaselineHashes, CurrentFiles, Diff);
+	TestTrue(TEXT("Changed file"), Diff.ChangedFiles.Num() == 1 && Diff.ChangedFiles[0] == 1);
+	TestTrue(TEXT("Added file"), Diff.AddedFiles.Num() == 1 && Diff.AddedFiles[0] == 2);
+	TestTrue(TEXT("Deleted file"), Diff.DeletedFiles.Num() == 1 && Diff.DeletedFiles[0] == TEXT("../../../MyProject/Content/Removed.uasset"));
+
+	// The baseline against itself is no patch at all.
+	CurrentFiles[1].Hash = TEXT("BBBB");
+	CurrentFiles.RemoveAt(2);
+	FExportPakCookedFileRecord& Removed = CurrentFiles[CurrentFiles.AddDefaulted()];
+	Removed.DestFilepath = TEXT("../../../MyProject/Content/Removed.uasset");
+	Removed.Hash = TEXT("CCCC");
+	FExportPakPatch::Diff(BaselineHashes, CurrentFiles, Diff);
+	TestTrue(TEXT("Unchanged root has an empty diff"), Diff.IsEmpty());
+
+	TestFalse(TEXT("Missing baseline"), FExportPakPatch::LoadBaselineCookedFiles(FPaths::Combine(TestDirectory, TEXT("Missing.json")), BaselineHashes));
+
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	return true;
+}
@@ -0,0 +1,54 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A cooked file of the closure of a root, as the description json lists it in cooked_files. */
+struct FExportPakCookedFileRecord
+{
+	FExportPakCookedFileRecord()
+		:
+		Size(0)
+	{
+	}
+
+	/** Path inside the pak, e.g. ../../../MyProject/Content/Maps/NewMap.umap */
+	FString DestFilepath;
+
+	int64 Size;
+
+	/** SHA1 of the content. */
+	FString Hash;
+};
+
+/** What changed in the cooked files of a root since the baseline export. */
+struct FExportPakPatchDiff
+{
+	/** Indices into the current records, of files whose content differs from the baseline. */
+	TArray<int32> ChangedFiles;
+
+	/** Indices into the current records, of files the baseline does not have. */
+	TArray<int32> AddedFiles;
+
+	/** DestFilepaths only the baseline has, sorted. A pak cannot delete files, so they are only listed. */
+	TArray<FString> DeletedFiles;
+
+	bool IsEmpty() const
+	{
+		return ChangedFiles.Num() == 0 && AddedFiles.Num() == 0 && DeletedFiles.Num() == 0;
+	}
+};
+
+/** Diffs the cooked files of a root against the description file a previous export wrote for it. */
+class FExportPakPatch
+{
+public:
+	/** <BaselineDirectory>/<Platform>/<hash>/<hash>.json, the layout of Saved/ExportPak/Paks. */
+	static FString GetBaselineDescriptionFilepath(const FString& BaselineDirectory, const FString& CookedPlatformName, const FString& HashedRootName);
+
+	/** DestFilepath to SHA1 of the cooked_files of a description file. Returns false if it is unreadable or has no cooked_files. */
+	static bool LoadBaselineCookedFiles(const FString& DescriptionFilepath, TMap<FString, FString>& OutHashes);
+
+	static void Diff(const TMap<FString, FString>& BaselineHashes, const TArray<FExportPakCookedFileRecord>& CurrentFiles, FExportPakPatchDiff& OutDiff);
+};
@@ -0,0 +1,135 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakProcessPool.h"
+#include "ExportPak.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformTime.h"
+
+FExportPakProcessPool::FExportPakProcessPool(int32 InMaxProcesses)
+	:
+	MaxProcesses(InMaxProcesses > 0 ? InMaxProcesses : GetDefaultMaxProcesses())
+{
+}
+
+int32 FExportPakProcessPool::GetDefaultMaxProcesses()
+{
+	return FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+}
+
+void FExportPakProcessPool::AddJob(const FExportPakProcessJob& Job)
+{
+	Jobs.Add(Job);
+}
+
+bool FExportPakProcessPool::LaunchJob(int32 JobIndex, FRunningProcess& OutRunningProcess)
+{
+	FExportPakProcessJob& Job = Jobs[JobIndex];
+
+	OutRunningProcess.JobIndex = JobIndex;
+	OutRunningProcess.PipeRead = nullptr;
+	OutRunningProcess.PipeWrite = nullptr;
+
+	verify(FPlatformProcess::CreatePipe(OutRunningProcess.PipeRead, OutRunningProcess.PipeWrite));
+	OutRunningProcess.StartTime = FPlatformTime::Seconds();
+	bool bLaunchDetached = false;
+	bool bLaunchHidden = true;
+	bool bLaunchReallyHidden = true;
+	uint32* OutProcessID = nullptr;
+	int32 PriorityModifier = -1;
+	const TCHAR* OptionalWorkingDirectory = nullptr;
+	OutRunningProcess.ProcessHandle = FPlatformProcess::CreateProc(
+		*Job.ExecutableFilepath, *Job.CommandLine,
+		bLaunchDetached, bLaunchHidden, bLaunchReallyHidden,
+		OutProcessID, PriorityModifier,
+		OptionalWorkingDirectory,
+		OutRunningProcess.PipeWrite
+	);
+
+	Job.LaunchSeconds = FPlatformTime::Seconds() - OutRunningProcess.StartTime;
+	Job.bLaunched = OutRunningProcess.ProcessHandle.IsValid();
+	if (!Job.bLaunched)
+	{
+		FPlatformProcess::ClosePipe(OutRunningProcess.PipeRead, OutRunningProcess.PipeWrite);
+	}
+
+	return Job.bLaunched;
+}
+
+void FExportPakProcessPool::Run(const FOnExportPakProcessJobFinished& OnJobFinished, const FThreadSafeBool* bCancelled)
+{
+	TArray<FRunningProcess> RunningProcesses;
+	RunningProcesses.Reserve(MaxProcesses);
+
+	int32 NextJobIndex = 0;
+	while (NextJobIndex < Jobs.Num() || RunningProcesses.Num() > 0)
+	{
+		if (bCancelled != nullptr && *bCancelled)
+		{
+			for (auto& RunningProcess : RunningProcesses)
+			{
+				// Kill the whole tree, UnrealPak may have spawned children with -multiprocess.
+				FPlatformProcess::TerminateProc(RunningProcess.ProcessHandle, true);
+				FPlatformProcess::CloseProc(RunningProcess.ProcessHandle);
+				FPlatformProcess::ClosePipe(RunningProcess.PipeRead, RunningProcess.PipeWrite);
+
+				Jobs[RunningProcess.JobIndex].bCancelled = true;
+				Jobs[RunningProcess.JobIndex].RunSeconds = FPlatformTime::Seconds() - RunningProcess.StartTime;
+				OnJobFinished.ExecuteIfBound(Jobs[RunningProcess.JobIndex]);
+			}
+			RunningProcesses.Empty();
+
+			for (; NextJobIndex < Jobs.Num(); ++NextJobIndex)
+			{
+				Jobs[NextJobIndex].bCancelled = true;
+				OnJobFinished.ExecuteIfBound(Jobs[NextJobIndex]);
+			}
+
+			break;
+		}
+
+		while (NextJobIndex < Jobs.Num() && RunningProcesses.Num() < MaxProcesses)
+		{
+			FRunningProcess RunningProcess;
+			if (LaunchJob(NextJobIndex, RunningProcess))
+			{
+				RunningProcesses.Add(RunningProcess);
+			}
+			else
+			{
+				OnJobFinished.ExecuteIfBound(Jobs[NextJobIndex]);
+			}
+			++NextJobIndex;
+		}
+
+		bool bAnyJobFinished = false;
+		for (int32 Index = RunningProcesses.Num() - 1; Index >= 0; --Index)
+		{
+			FRunningProcess& RunningProcess = RunningProcesses[Index];
+			FExportPakProcessJob& Job = Jobs[RunningProcess.JobIndex];
+
+			// Drain the pipe while the child is alive, otherwise a chatty UnrealPak blocks on a full pipe.
+			Job.StdOut += FPlatformProcess::ReadPipe(RunningProcess.PipeRead);
+
+			if (FPlatformProcess::IsProcRunning(RunningProcess.ProcessHandle))
+			{
+				continue;
+			}
+
+			Job.StdOut += FPlatformProcess::ReadPipe(RunningProcess.PipeRead);
+			Job.RunSeconds = FPlatformTime::Seconds() - RunningProcess.StartTime;
+			FPlatformProcess::GetProcReturnCode(RunningProcess.ProcessHandle, &Job.ReturnCode);
+
+			FPlatformProcess::CloseProc(RunningProcess.ProcessHandle);
+			FPlatformProcess::ClosePipe(RunningProcess.PipeRead, RunningProcess.PipeWrite);
+			RunningProcesses.RemoveAtSwap(Index);
+
+			OnJobFinished.ExecuteIfBound(Job);
+			bAnyJobFinished = true;
+		}
+
+		if (!bAnyJobFinished && RunningProcesses.Num() > 0)
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+	}
+}
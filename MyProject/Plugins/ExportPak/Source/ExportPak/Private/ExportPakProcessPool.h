@@ -0,0 +1,94 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/ThreadSafeBool.h"
+
+/** One UnrealPak invocation queued into FExportPakProcessPool. */
+struct FExportPakProcessJob
+{
+	FExportPakProcessJob()
+		:
+		ReturnCode(-1),
+		bLaunched(false),
+		bCancelled(false),
+		LaunchSeconds(0.0),
+		RunSeconds(0.0)
+	{
+	}
+
+	/** Used for logging only, normally the long package name the pak is built for. */
+	FString Name;
+
+	FString ExecutableFilepath;
+
+	FString CommandLine;
+
+	/** Filled in by the pool once the process has exited. */
+	int32 ReturnCode;
+
+	/** Everything the process wrote to stdout. */
+	FString StdOut;
+
+	/** False if CreateProc failed, ReturnCode and StdOut are meaningless then. */
+	bool bLaunched;
+
+	/** True if the pool was cancelled before the job finished, its process was killed or never started. */
+	bool bCancelled;
+
+	/** Time spent in CreateProc. */
+	double LaunchSeconds;
+
+	/** Time from launch to exit, or to the kill of a cancelled job. */
+	double RunSeconds;
+};
+
+DECLARE_DELEGATE_OneParam(FOnExportPakProcessJobFinished, const FExportPakProcessJob& /*Job*/);
+
+/**
+ * Bounded pool of child processes.
+ * Keeps at most MaxProcesses jobs in flight and blocks in Run() until all queued jobs have finished.
+ */
+class FExportPakProcessPool
+{
+public:
+	/** @param InMaxProcesses	Number of concurrent processes, <= 0 means GetDefaultMaxProcesses(). */
+	explicit FExportPakProcessPool(int32 InMaxProcesses);
+
+	/** Queue a job. Must not be called while Run() is executing. */
+	void AddJob(const FExportPakProcessJob& Job);
+
+	/**
+	 * Launch all queued jobs and wait for them.
+	 *
+	 * @param OnJobFinished		Called on the calling thread each time a job exits or fails to launch.
+	 * @param bCancelled		Optional, once it becomes true no job is launched anymore and running processes are killed.
+	 */
+	void Run(const FOnExportPakProcessJobFinished& OnJobFinished, const FThreadSafeBool* bCancelled = nullptr);
+
+	const TArray<FExportPakProcessJob>& GetJobs() const { return Jobs; }
+
+	int32 GetMaxProcesses() const { return MaxProcesses; }
+
+	/** One process per logical core. */
+	static int32 GetDefaultMaxProcesses();
+
+private:
+	struct FRunningProcess
+	{
+		int32 JobIndex;
+		double StartTime;
+		FProcHandle ProcessHandle;
+		void* PipeRead;
+		void* PipeWrite;
+	};
+
+	bool LaunchJob(int32 JobIndex, FRunningProcess& OutRunningProcess);
+
+private:
+	int32 MaxProcesses;
+
+	TArray<FExportPakProcessJob> Jobs;
+};
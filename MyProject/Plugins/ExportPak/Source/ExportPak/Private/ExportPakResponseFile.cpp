@@ -0,0 +1,168 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakResponseFile.h"
+#include "ExportPak.h"
+#include "FileHelper.h"
+#include "FileManager.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+#include "Templates/UniquePtr.h"
+
+FExportPakResponseFileWriter::FExportPakResponseFileWriter(FArchive& InArchive)
+	:
+	Archive(InArchive)
+{
+	LineBuffer.Reserve(1024);
+}
+
+void FExportPakResponseFileWriter::AppendChar(ANSICHAR Char)
+{
+	LineBuffer.Add(Char);
+}
+
+void FExportPakResponseFileWriter::AppendQuoted(const FString& Path)
+{
+	AppendChar('"');
+
+	const int32 ConvertedLength = FTCHARToUTF8_Convert::ConvertedLength(*Path, Path.Len());
+	const int32 Offset = LineBuffer.Num();
+	LineBuffer.AddUninitialized(ConvertedLength);
+	FTCHARToUTF8_Convert::Convert(LineBuffer.GetData() + Offset, ConvertedLength, *Path, Path.Len());
+
+	AppendChar('"');
+}
+
+void FExportPakResponseFileWriter::AddEntry(const FExportPakFileEntry& File)
+{
+	LineBuffer.Reset();
+
+	AppendQuoted(File.SourceFilepath);
+	AppendChar(' ');
+	AppendQuoted(File.DestFilepath);
+	if (File.CompressionMethod != COMPRESS_None)
+	{
+		// UnrealPak compresses the files of a line with -compress with its default codec, zlib.
+		for (const ANSICHAR* Switch = " -compress"; *Switch; ++Switch)
+		{
+			AppendChar(*Switch);
+		}
+	}
+	AppendChar('\n');
+
+	Archive.Serialize(LineBuffer.GetData(), LineBuffer.Num());
+}
+
+void FExportPakResponseFileWriter::AddOrderEntry(const FExportPakFileEntry& File, int32 Order)
+{
+	LineBuffer.Reset();
+
+	AppendQuoted(File.DestFilepath);
+	AppendChar(' ');
+	const FString OrderString = FString::FromInt(Order);
+	for (const TCHAR* Digit = *OrderString; *Digit; ++Digit)
+	{
+		AppendChar((ANSICHAR)*Digit);
+	}
+	AppendChar('\n');
+
+	Archive.Serialize(LineBuffer.GetData(), LineBuffer.Num());
+}
+
+bool FExportPakResponseFileWriter::Save(const FString& ResponseFilepath, const TArray<FExportPakFileEntry>& Files)
+{
+	TUniquePtr<FArchive> FileArchive(IFileManager::Get().CreateFileWriter(*ResponseFilepath));
+	if (!FileArchive)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to create response file: %s"), *ResponseFilepath);
+		return false;
+	}
+
+	FExportPakResponseFileWriter ResponseFileWriter(*FileArchive);
+	for (const auto& File : Files)
+	{
+		ResponseFileWriter.AddEntry(File);
+	}
+
+	const bool bSuccess = FileArchive->Close() && !FileArchive->IsError();
+	if (!bSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to write response file: %s"), *ResponseFilepath);
+	}
+
+	return bSuccess;
+}
+
+bool FExportPakResponseFileWriter::SaveOrderFile(const FString& OrderFilepath, const TArray<FExportPakFileEntry>& Files)
+{
+	TUniquePtr<FArchive> FileArchive(IFileManager::Get().CreateFileWriter(*OrderFilepath));
+	if (!FileArchive)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to create order file: %s"), *OrderFilepath);
+		return false;
+	}
+
+	FExportPakResponseFileWriter OrderFileWriter(*FileArchive);
+	for (int32 Index = 0; Index < Files.Num(); ++Index)
+	{
+		OrderFileWriter.AddOrderEntry(Files[Index], Index + 1);
+	}
+
+	const bool bSuccess = FileArchive->Close() && !FileArchive->IsError();
+	if (!bSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to write order file: %s"), *OrderFilepath);
+	}
+
+	return bSuccess;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakResponseFileBenchmark, "ExportPak.ResponseFile.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakResponseFileBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumEntries = 50000;
+
+	TArray<FExportPakFileEntry> Files;
+	Files.Reserve(NumEntries);
+	for (int32 Index = 0; Index < NumEntries; ++Index)
+	{
+		Files.Add(FExportPakFileEntry(
+			FString::Printf(TEXT("D:/Projects/MyProject/Saved/Cooked/WindowsNoEditor/MyProject/Content/Synthetic/Folder_%d/Asset_%d.uexp"), Index / 100, Index),
+			FString::Printf(TEXT("../../../MyProject/Content/Synthetic/Folder_%d/Asset_%d.uexp"), Index / 100, Index)
+		));
+	}
+	// Non-ASCII paths must come out as UTF-8 and not force the whole file to UTF-16.
+	Files.Add(FExportPakFileEntry(TEXT("D:/Projects/MyProject/Content/\u5730\u56FE.umap"), TEXT("../../../MyProject/Content/\u5730\u56FE.umap")));
+
+	const FString LegacyFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/ResponseFileBenchmark_Legacy.txt"));
+	const FString StreamedFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/ResponseFileBenchmark_Streamed.txt"));
+
+	// The way response files used to be written.
+	double StartTime = FPlatformTime::Seconds();
+	{
+		FString ResponseFileContent = "";
+		for (const auto& File : Files)
+		{
+			ResponseFileContent += FString::Printf(TEXT("\"%s\" \"%s\"\n"), *File.SourceFilepath, *File.DestFilepath);
+		}
+		FFileHelper::SaveStringToFile(ResponseFileContent, *LegacyFilepath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	}
+	const double LegacyTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	TestTrue(TEXT("Save"), FExportPakResponseFileWriter::Save(StreamedFilepath, Files));
+	const double StreamedTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogExportPak, Display, TEXT("ResponseFile benchmark: %d entries, FString + SaveStringToFile %.3f s, streamed %.3f s."), Files.Num(), LegacyTime, StreamedTime);
+
+	TArray<uint8> LegacyBytes;
+	TArray<uint8> StreamedBytes;
+	FFileHelper::LoadFileToArray(LegacyBytes, *LegacyFilepath);
+	FFileHelper::LoadFileToArray(StreamedBytes, *StreamedFilepath);
+	TestTrue(TEXT("Same bytes as the legacy path"), LegacyBytes == StreamedBytes);
+
+	IFileManager::Get().Delete(*LegacyFilepath);
+	IFileManager::Get().Delete(*StreamedFilepath);
+
+	return true;
+}
@@ -0,0 +1,38 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ExportPakWriter.h"
+
+/**
+ * Streams the lines of an UnrealPak response file ("Source" "Dest") to an archive as UTF-8.
+ * Every line is encoded into one reused buffer, so no FString is built per entry and the whole
+ * file is never held in memory.
+ */
+class FExportPakResponseFileWriter
+{
+public:
+	explicit FExportPakResponseFileWriter(FArchive& InArchive);
+
+	void AddEntry(const FExportPakFileEntry& File);
+
+	/** A line of an UnrealPak -order file, "Dest" Order. */
+	void AddOrderEntry(const FExportPakFileEntry& File, int32 Order);
+
+	/** Write a whole response file, creating its directory. */
+	static bool Save(const FString& ResponseFilepath, const TArray<FExportPakFileEntry>& Files);
+
+	/** Write an -order file that keeps the files in the order of the array, UnrealPak otherwise sorts them its own way. */
+	static bool SaveOrderFile(const FString& OrderFilepath, const TArray<FExportPakFileEntry>& Files);
+
+private:
+	void AppendQuoted(const FString& Path);
+
+	void AppendChar(ANSICHAR Char);
+
+private:
+	FArchive& Archive;
+
+	TArray<ANSICHAR> LineBuffer;
+};
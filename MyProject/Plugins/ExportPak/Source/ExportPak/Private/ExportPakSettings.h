@@ -9,6 +9,72 @@
 #include "Engine/EngineTypes.h"
 #include "ExportPakSettings.generated.h"
 
+/** Codecs both UnrealPak and the pak reader of this engine version support. */
+UENUM()
+enum class EExportPakCompressionFormat : uint8
+{
+	None,
+	Zlib,
+};
+
+/** How the cooked files of a package are compressed in its pak. */
+USTRUCT()
+struct FExportPakCompressionProfile
+{
+	GENERATED_BODY()
+
+	FExportPakCompressionProfile()
+		:
+		Format(EExportPakCompressionFormat::Zlib),
+		BlockSizeInKilobytes(64),
+		MinSizeToCompressInBytes(4096)
+	{
+	}
+
+	UPROPERTY(EditAnywhere, Category = Default)
+	EExportPakCompressionFormat Format;
+
+	/** Files are compressed in blocks of this size, larger blocks compress better but a read decompresses a whole block. One block size per pak, see ClassCompressionProfiles.*/
+	UPROPERTY(EditAnywhere, Category = Default, meta = (ClampMin = "1"))
+	int32 BlockSizeInKilobytes;
+
+	/** Files smaller than this stay raw, they would not win enough to pay for the decompression.*/
+	UPROPERTY(EditAnywhere, Category = Default, meta = (ClampMin = "0"))
+	int32 MinSizeToCompressInBytes;
+};
+
+USTRUCT()
+struct FExportPakClassCompressionProfile
+{
+	GENERATED_BODY()
+
+	/** Asset class of the package, e.g. Texture2D, SoundWave or StaticMesh.*/
+	UPROPERTY(EditAnywhere, Category = Default)
+	FString AssetClass;
+
+	UPROPERTY(EditAnywhere, Category = Default)
+	FExportPakCompressionProfile Profile;
+};
+
+/** Packages of a root that go into a pak of their own instead of the batch or individual paks. */
+USTRUCT()
+struct FExportPakGroupingRule
+{
+	GENERATED_BODY()
+
+	/** Asset classes the rule takes, e.g. StaticMesh and Material. Empty takes any class.*/
+	UPROPERTY(EditAnywhere, Category = Default)
+	TArray<FString> AssetClasses;
+
+	/** Long package name prefixes the rule takes, e.g. /Game/Audio/. Empty takes any path.*/
+	UPROPERTY(EditAnywhere, Category = Default)
+	TArray<FString> PathPrefixes;
+
+	/** The matching packages of a root go into <hash of the root>_<GroupName>.pak. Empty gives every matching package a pak of its own, as in individual mode.*/
+	UPROPERTY(EditAnywhere, Category = Default)
+	FString GroupName;
+};
+
 /** Singleton wrapper to allow for using the setting structure in SSettingsView */
 UCLASS(config = Game)
 class UExportPakSettings : public UObject
@@ -17,8 +83,21 @@ class UExportPakSettings : public UObject
 public:
 	UExportPakSettings()
 		:
-		bUseBatchMode (false)
+		bUseBatchMode (false),
+		MaxConcurrentPakJobs(0),
+		bUseUnrealPak(false),
+		bSkipUnchangedPaks(true),
+		bUseSharedPakStore(true),
+		MaxConcurrentRoots(1),
+		MaxBatchPakSizeInMegabytes(0),
+		bSaveDependenciesInfoJson(true),
+		bLegacyPackageNameHashes(false),
+		bRecordCookedFileHashes(false),
+		bExportPatch(false),
+		bVerifyPaks(false),
+		DigestBlockSizeInKilobytes(4096)
 	{
+		TargetPlatforms.Add(TEXT("WindowsNoEditor"));
 	}
 
 	static UExportPakSettings* Get()
@@ -40,6 +119,96 @@ public:
 	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default)
 	bool  bUseBatchMode;
 
+	/** Number of UnrealPak processes running at the same time in individual mode. 0 means one per logical core.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default, meta = (ClampMin = "0"))
+	int32 MaxConcurrentPakJobs;
+
+	/** If true, spawn UnrealPak.exe for every pak instead of writing the pak files in-process.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default)
+	bool bUseUnrealPak;
+
+	/** If true, paks whose cooked inputs and options did not change since the last export are not rebuilt. See Saved/ExportPak/ExportCache.json.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default)
+	bool bSkipUnchangedPaks;
+
+	/** If true, individual paks go to ExportPak/Paks/Shared and are built once however many roots depend on them. Ignored in batch mode.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default)
+	bool bUseSharedPakStore;
+
+	/** Number of root packages exported at the same time. 1 exports them one after another with a progress dialog per root.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default, meta = (ClampMin = "1"))
+	int32 MaxConcurrentRoots;
+
+	/** In batch mode, split the pak of a root into chunks of at most this size. A package is never split. 0 means one pak per root.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default, meta = (ClampMin = "0"))
+	int32 MaxBatchPakSizeInMegabytes;
+
+	/** If true, AssetDependencies.json is written next to AssetDependencies.bin. It is only meant for reading by people, it gets large with many roots.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default)
+	bool bSaveDependenciesInfoJson;
+
+	/**
+	 * If true, pak names hash the ANSI conversion of the package name like exports before UTF-8 hashing did, to keep the names of shipped paks.
+	 * Only names with non-ASCII characters are affected: they all collapse to '?' that way.
+	 */
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default)
+	bool bLegacyPackageNameHashes;
+
+	/** Compression of the packages no entry of ClassCompressionProfiles matches.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Compression)
+	FExportPakCompressionProfile DefaultCompression;
+
+	/**
+	 * Compression per asset class, e.g. no compression for already compressed SoundWave data.
+	 * The block size of a batch pak is always the one of DefaultCompression.
+	 */
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Compression)
+	TArray<FExportPakClassCompressionProfile> ClassCompressionProfiles;
+
+	/**
+	 * Rules to split the packages of a root by asset class and path, e.g. meshes with their materials in one pak and textures in paks of their own.
+	 * A package takes the first rule it matches, packages no rule matches go into the paks of the mode. The description file lists the groups in pak_groups.
+	 */
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Grouping)
+	TArray<FExportPakGroupingRule> GroupingRules;
+
+	/**
+	 * GameOpenOrder.log of a playtest run with -fileopenlog. If set, the files inside every pak, batch chunks included, are laid out
+	 * in the order the game opened them, and the description file reports the seeks a load is expected to save.
+	 */
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Layout)
+	FFilePath FileOpenOrderLog;
+
+	/**
+	 * If true, the description file of a root lists every cooked file of its closure with its SHA1 in cooked_files, so a later export can patch it.
+	 * Turn it on for the export that ships. With bSkipUnchangedPaks only files whose size or timestamp changed are read again.
+	 */
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Patch)
+	bool bRecordCookedFileHashes;
+
+	/**
+	 * If true, no full paks are written. A root only gets a <hash>_P.pak with the cooked files that changed or were added
+	 * since PatchBaselineDirectory, and a <hash>_P.json that also lists the deleted ones.
+	 */
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Patch)
+	bool bExportPatch;
+
+	/** Saved/ExportPak/Paks of the export to patch, e.g. kept from the shipped build. Its description files must have cooked_files.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Patch)
+	FDirectoryPath PatchBaselineDirectory;
+
+	/** If true, every pak is opened once written and its entries are checked against the cooked files meant to go into it. The description file then has the SHA1 digests of the paks.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Verification)
+	bool bVerifyPaks;
+
+	/** Paks are hashed in blocks of this size on all cores. The description file lists the SHA1 of every block, so a download can be checked as it arrives.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Verification, meta = (ClampMin = "64"))
+	int32 DigestBlockSizeInKilobytes;
+
+	/** Cooked platforms to export, e.g. WindowsNoEditor, LinuxNoEditor or Android_ETC2. Dependencies are gathered once for all of them.*/
+	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = Default)
+	TArray<FString> TargetPlatforms;
+
 	/** You can use copied asset string reference here, e.g. World'/Game/NewMap.NewMap'*/
 	UPROPERTY(config, EditAnywhere, BlueprintReadWrite, Category = "Target Asset List")
 	TArray<FFilePath> PackagesToExport;
@@ -0,0 +1,137 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakSharedPakStore.h"
+#include "ExportPak.h"
+#include "ExportPakParallel.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/PlatformProcess.h"
+
+FString FExportPakSharedPakStore::MakeKey(const FString& CookedPlatformName, const FString& PackageName)
+{
+	return CookedPlatformName / PackageName;
+}
+
+bool FExportPakSharedPakStore::Claim(const FString& Key)
+{
+	FScopeLock StatesLock(&StatesCritical);
+	if (States.Contains(Key))
+	{
+		return false;
+	}
+
+	States.Add(Key, EExportPakSharedPakState::Building);
+	return true;
+}
+
+void FExportPakSharedPakStore::Finish(const FString& Key, bool bBuilt)
+{
+	FScopeLock StatesLock(&StatesCritical);
+	check(States.FindRef(Key) == EExportPakSharedPakState::Building);
+	States.Add(Key, bBuilt ? EExportPakSharedPakState::Built : EExportPakSharedPakState::Failed);
+}
+
+EExportPakSharedPakState FExportPakSharedPakStore::GetState(const FString& Key) const
+{
+	FScopeLock StatesLock(&StatesCritical);
+	const EExportPakSharedPakState* State = States.Find(Key);
+	return State ? *State : EExportPakSharedPakState::Built;
+}
+
+bool FExportPakSharedPakStore::Wait(const TArray<FString>& Keys, const FThreadSafeBool& bCancelRequested) const
+{
+	for (const auto& Key : Keys)
+	{
+		EExportPakSharedPakState State;
+		while ((State = GetState(Key)) == EExportPakSharedPakState::Building)
+		{
+			if (bCancelRequested)
+			{
+				return false;
+			}
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		if (State == EExportPakSharedPakState::Failed)
+		{
+			UE_LOG(LogExportPak, Error, TEXT("The shared pak of %s was not written."), *Key);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FExportPakSharedPakStore::Reset()
+{
+	FScopeLock StatesLock(&StatesCritical);
+	States.Empty();
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakSharedPakStoreTest, "ExportPak.SharedPakStore", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakSharedPakStoreTest::RunTest(const FString& Parameters)
+{
+	// Two roots exported at once, like MaxConcurrentRoots = 2, that share the dependency Common.
+	// Whichever claims it first writes it slowly, the other must not describe it before it is done.
+	const TArray<FString> RootPackages[] =
+	{
+		{ TEXT("/Game/Maps/MapA"), TEXT("/Game/Props/Common") },
+		{ TEXT("/Game/Maps/MapB"), TEXT("/Game/Props/Common") },
+	};
+
+	for (const bool bCommonBuilt : { true, false })
+	{
+		FExportPakSharedPakStore SharedPaks;
+		FThreadSafeBool bCancelRequested(false);
+		FThreadSafeBool bCommonFinished(false);
+		bool bDescribedBeforeFinished[2] = { false, false };
+		bool bDescribed[2] = { false, false };
+		if (!bCommonBuilt)
+		{
+			AddExpectedError(TEXT("was not written"), EAutomationExpectedErrorFlags::Contains, 2);
+		}
+
+		ExportPakParallelFor(2, 2, EAsyncExecution::Thread,
+			[&](int32 RootIndex)
+			{
+				TArray<FString> Keys;
+				for (const auto& Package : RootPackages[RootIndex])
+				{
+					const FString Key = FExportPakSharedPakStore::MakeKey(TEXT("WindowsNoEditor"), Package);
+					Keys.Add(Key);
+					if (SharedPaks.Claim(Key))
+					{
+						const bool bCommon = Package == TEXT("/Game/Props/Common");
+						if (bCommon)
+						{
+							FPlatformProcess::Sleep(0.05f);
+							bCommonFinished = true;
+						}
+						SharedPaks.Finish(Key, !bCommon || bCommonBuilt);
+					}
+				}
+
+				bDescribed[RootIndex] = SharedPaks.Wait(Keys, bCancelRequested);
+				bDescribedBeforeFinished[RootIndex] = !bCommonFinished;
+			},
+			[](int32 NumFinished) {});
+
+		for (int32 RootIndex = 0; RootIndex < 2; ++RootIndex)
+		{
+			TestEqual(FString::Printf(TEXT("Root %d described only if the shared pak was written"), RootIndex), bDescribed[RootIndex], bCommonBuilt);
+			TestFalse(FString::Printf(TEXT("Root %d waited for the shared pak"), RootIndex), bDescribedBeforeFinished[RootIndex]);
+		}
+		TestTrue(TEXT("Final state of the shared pak"), SharedPaks.GetState(FExportPakSharedPakStore::MakeKey(TEXT("WindowsNoEditor"), TEXT("/Game/Props/Common"))) == (bCommonBuilt ? EExportPakSharedPakState::Built : EExportPakSharedPakState::Failed));
+	}
+
+	// A waiting root gives up when the export is cancelled.
+	FExportPakSharedPakStore SharedPaks;
+	TestTrue(TEXT("Claimed"), SharedPaks.Claim(TEXT("WindowsNoEditor/Game/Props/Common")));
+	TestFalse(TEXT("Claimed twice"), SharedPaks.Claim(TEXT("WindowsNoEditor/Game/Props/Common")));
+	FThreadSafeBool bCancelRequested(true);
+	TestFalse(TEXT("Cancelled wait"), SharedPaks.Wait({ TEXT("WindowsNoEditor/Game/Props/Common") }, bCancelRequested));
+	TestTrue(TEXT("Unclaimed keys do not block"), SharedPaks.Wait({ TEXT("WindowsNoEditor/Game/Props/Other") }, bCancelRequested));
+
+	return true;
+}
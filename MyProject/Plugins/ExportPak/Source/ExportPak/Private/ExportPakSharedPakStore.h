@@ -0,0 +1,52 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+
+/** Where the pak of a package in the shared store is. */
+enum class EExportPakSharedPakState : uint8
+{
+	/** A root claimed the package and is writing its pak. */
+	Building,
+
+	/** The pak is written and verified. */
+	Built,
+
+	/** The pak is missing or incomplete, roots that need it must not describe it. */
+	Failed,
+};
+
+/**
+ * Which root writes the pak of each package of the shared store, and whether it is done.
+ * The first root that needs a package claims it, the others skip it and wait for it before they write their
+ * description files, so a description never points at a pak that is still being written or never was.
+ */
+class FExportPakSharedPakStore
+{
+public:
+	/** <Platform>/<Package> */
+	static FString MakeKey(const FString& CookedPlatformName, const FString& PackageName);
+
+	/** True if the caller claimed the pak. It then has to write it and Finish() it, also when it gives up. */
+	bool Claim(const FString& Key);
+
+	void Finish(const FString& Key, bool bBuilt);
+
+	/**
+	 * Waits until none of the paks is being written, by polling like TExportPakBoundedQueue.
+	 * Returns false if one of them failed, or if bCancelRequested is set meanwhile. Keys nobody claimed do not count.
+	 */
+	bool Wait(const TArray<FString>& Keys, const FThreadSafeBool& bCancelRequested) const;
+
+	EExportPakSharedPakState GetState(const FString& Key) const;
+
+	void Reset();
+
+private:
+	TMap<FString, EExportPakSharedPakState> States;
+
+	mutable FCriticalSection StatesCritical;
+};
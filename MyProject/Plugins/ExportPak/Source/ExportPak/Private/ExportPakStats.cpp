@@ -0,0 +1,90 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakStats.h"
+#include "Misc/ScopeLock.h"
+#include "json.h"
+
+DEFINE_STAT(STAT_ExportPak_DependencyWalk);
+DEFINE_STAT(STAT_ExportPak_CookedIndex);
+DEFINE_STAT(STAT_ExportPak_CookedFileDiscovery);
+DEFINE_STAT(STAT_ExportPak_CacheCheck);
+DEFINE_STAT(STAT_ExportPak_CookedFileHash);
+DEFINE_STAT(STAT_ExportPak_ResponseFile);
+DEFINE_STAT(STAT_ExportPak_PakWrite);
+DEFINE_STAT(STAT_ExportPak_PakVerification);
+DEFINE_STAT(STAT_ExportPak_DescriptionFile);
+
+void FExportPakStats::Add(EExportPakStage Stage, double Seconds, int64 Files, int64 Bytes)
+{
+	FScopeLock StagesLock(&StagesCritical);
+
+	FExportPakStageStats& StageStats = Stages[(int32)Stage];
+	StageStats.Seconds += Seconds;
+	StageStats.Calls += 1;
+	StageStats.Files += Files;
+	StageStats.Bytes += Bytes;
+}
+
+void FExportPakStats::Append(const FExportPakStats& Other)
+{
+	for (int32 StageIndex = 0; StageIndex < (int32)EExportPakStage::Num; ++StageIndex)
+	{
+		const FExportPakStageStats OtherStage = Other.GetStage((EExportPakStage)StageIndex);
+
+		FScopeLock StagesLock(&StagesCritical);
+		FExportPakStageStats& StageStats = Stages[StageIndex];
+		StageStats.Seconds += OtherStage.Seconds;
+		StageStats.Calls += OtherStage.Calls;
+		StageStats.Files += OtherStage.Files;
+		StageStats.Bytes += OtherStage.Bytes;
+	}
+}
+
+FExportPakStageStats FExportPakStats::GetStage(EExportPakStage Stage) const
+{
+	FScopeLock StagesLock(&StagesCritical);
+	return Stages[(int32)Stage];
+}
+
+const TCHAR* FExportPakStats::GetStageName(EExportPakStage Stage)
+{
+	switch (Stage)
+	{
+	case EExportPakStage::DependencyWalk:		return TEXT("dependency_walk");
+	case EExportPakStage::CookedIndex:			return TEXT("cooked_index");
+	case EExportPakStage::CookedFileDiscovery:	return TEXT("cooked_file_discovery");
+	case EExportPakStage::CacheCheck:			return TEXT("cache_check");
+	case EExportPakStage::CookedFileHash:		return TEXT("cooked_file_hash");
+	case EExportPakStage::ResponseFile:			return TEXT("response_file");
+	case EExportPakStage::ProcessSpawn:			return TEXT("process_spawn");
+	case EExportPakStage::UnrealPakProcess:		return TEXT("unrealpak_process");
+	case EExportPakStage::PakWrite:				return TEXT("pak_write");
+	case EExportPakStage::PakVerification:		return TEXT("pak_verification");
+	case EExportPakStage::DescriptionFile:		return TEXT("description_file");
+	default:									return TEXT("unknown");
+	}
+}
+
+TSharedRef<FJsonObject> FExportPakStats::ToJson() const
+{
+	TSharedRef<FJsonObject> StagesJsonObject = MakeShareable(new FJsonObject);
+	for (int32 StageIndex = 0; StageIndex < (int32)EExportPakStage::Num; ++StageIndex)
+	{
+		const FExportPakStageStats StageStats = GetStage((EExportPakStage)StageIndex);
+		if (StageStats.Calls == 0)
+		{
+			continue;
+		}
+
+		TSharedPtr<FJsonObject> StageJsonObject = MakeShareable(new FJsonObject);
+		StageJsonObject->SetNumberField("seconds", StageStats.Seconds);
+		StageJsonObject->SetNumberField("calls", (double)StageStats.Calls);
+		StageJsonObject->SetNumberField("files", (double)StageStats.Files);
+		// Same as file_size_in_bytes of the description files, int64 does not fit a JSON number.
+		StageJsonObject->SetStringField("bytes", FString::Printf(TEXT("%lld"), StageStats.Bytes));
+
+		StagesJsonObject->SetObjectField(GetStageName((EExportPakStage)StageIndex), StageJsonObject);
+	}
+
+	return StagesJsonObject;
+}
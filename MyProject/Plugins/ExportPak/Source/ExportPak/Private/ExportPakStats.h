@@ -0,0 +1,114 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_STATS_GROUP(TEXT("ExportPak"), STATGROUP_ExportPak, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dependency walk"), STAT_ExportPak_DependencyWalk, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cooked tree index"), STAT_ExportPak_CookedIndex, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cooked file discovery"), STAT_ExportPak_CookedFileDiscovery, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Export cache check"), STAT_ExportPak_CacheCheck, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cooked file hash"), STAT_ExportPak_CookedFileHash, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Response file write"), STAT_ExportPak_ResponseFile, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pak write"), STAT_ExportPak_PakWrite, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pak verification"), STAT_ExportPak_PakVerification, STATGROUP_ExportPak, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Description file"), STAT_ExportPak_DescriptionFile, STATGROUP_ExportPak, );
+
+/** Stages of an export, in the order they first run. */
+enum class EExportPakStage : uint8
+{
+	DependencyWalk,
+	CookedIndex,
+	CookedFileDiscovery,
+	CacheCheck,
+	/** SHA1 of the cooked files for cooked_files and patches. */
+	CookedFileHash,
+	ResponseFile,
+	/** CreateProc of UnrealPak. */
+	ProcessSpawn,
+	/** Lifetime of an UnrealPak process. */
+	UnrealPakProcess,
+	PakWrite,
+	/** Entry check and digests of the written paks. */
+	PakVerification,
+	DescriptionFile,
+
+	Num
+};
+
+struct FExportPakStageStats
+{
+	FExportPakStageStats()
+		:
+		Seconds(0.0),
+		Calls(0),
+		Files(0),
+		Bytes(0)
+	{
+	}
+
+	/** Summed over threads, so it can exceed the wall time of the export. */
+	double Seconds;
+	int64 Calls;
+	int64 Files;
+	int64 Bytes;
+};
+
+/** Time, files and bytes per stage. Add() may be called from any thread. */
+class FExportPakStats
+{
+public:
+	void Add(EExportPakStage Stage, double Seconds, int64 Files, int64 Bytes);
+
+	void Append(const FExportPakStats& Other);
+
+	FExportPakStageStats GetStage(EExportPakStage Stage) const;
+
+	static const TCHAR* GetStageName(EExportPakStage Stage);
+
+	/** { "<stage>": { "seconds", "calls", "files", "bytes" }, ... }, stages that never ran are left out. */
+	TSharedRef<class FJsonObject> ToJson() const;
+
+private:
+	FExportPakStageStats Stages[(int32)EExportPakStage::Num];
+
+	mutable FCriticalSection StagesCritical;
+};
+
+/** Adds the time between construction and destruction to a stage, with the files and bytes set meanwhile. */
+class FExportPakScopedStageTimer
+{
+public:
+	FExportPakScopedStageTimer(FExportPakStats& InStats, EExportPakStage InStage)
+		:
+		Stats(InStats),
+		Stage(InStage),
+		StartTime(FPlatformTime::Seconds()),
+		Files(0),
+		Bytes(0)
+	{
+	}
+
+	~FExportPakScopedStageTimer()
+	{
+		Stats.Add(Stage, FPlatformTime::Seconds() - StartTime, Files, Bytes);
+	}
+
+	void AddFiles(int64 InFiles, int64 InBytes)
+	{
+		Files += InFiles;
+		Bytes += InBytes;
+	}
+
+private:
+	FExportPakStats& Stats;
+	EExportPakStage Stage;
+	double StartTime;
+	int64 Files;
+	int64 Bytes;
+};
@@ -0,0 +1,208 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakVerifier.h"
+#include "ExportPak.h"
+#include "ExportPakWriter.h"
+#include "ExportPakFileCopy.h"
+#include "IPlatformFilePak.h"
+#include "PlatformFilemanager.h"
+#include "FileHelper.h"
+#include "FileManager.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Templates/UniquePtr.h"
+
+bool FExportPakVerifier::CheckEntries(const FString& PakFilepath, const TArray<FExportPakFileEntry>& ExpectedFiles, FExportPakVerification& OutVerification)
+{
+	OutVerification = FExportPakVerification();
+
+	if (!IFileManager::Get().FileExists(*PakFilepath))
+	{
+		return false;
+	}
+
+	FPakFile PakFile(&FPlatformFileManager::Get().GetPlatformFile(), *PakFilepath, false);
+	if (!PakFile.IsValid())
+	{
+		return false;
+	}
+	OutVerification.bPakReadable = true;
+
+	TMap<FString, const FExportPakFileEntry*> RemainingFiles;
+	for (const auto& File : ExpectedFiles)
+	{
+		RemainingFiles.Add(File.DestFilepath, &File);
+	}
+
+	for (FPakFile::FFileIterator It(PakFile); It; ++It)
+	{
+		const FString EntryPath = PakFile.GetMountPoint() + It.Filename();
+
+		const FExportPakFileEntry* ExpectedFile = nullptr;
+		if (!RemainingFiles.RemoveAndCopyValue(EntryPath, ExpectedFile))
+		{
+			OutVerification.UnexpectedFiles.Add(EntryPath);
+			continue;
+		}
+
+		// The size is unknown for files that were not in the cooked index.
+		if (ExpectedFile->Size >= 0 && It.Info().UncompressedSize != ExpectedFile->Size)
+		{
+			OutVerification.MismatchedFiles.Add(EntryPath);
+		}
+	}
+
+	RemainingFiles.GenerateKeyArray(OutVerification.MissingFiles);
+	OutVerification.MissingFiles.Sort();
+	OutVerification.UnexpectedFiles.Sort();
+	OutVerification.MismatchedFiles.Sort();
+
+	return OutVerification.IsValid();
+}
+
+bool FExportPakVerifier::ComputeDigest(const FString& PakFilepath, int64 BlockSize, FExportPakDigest& OutDigest)
+{
+	OutDigest = FExportPakDigest();
+	OutDigest.FileSize = IFileManager::Get().FileSize(*PakFilepath);
+	OutDigest.BlockSize = FMath::Max<int64>(BlockSize, 1);
+	if (OutDigest.FileSize < 0)
+	{
+		return false;
+	}
+
+	const int32 NumBlocks = (int32)((OutDigest.FileSize + OutDigest.BlockSize - 1) / OutDigest.BlockSize);
+	OutDigest.BlockHashes.SetNum(NumBlocks);
+
+	// Mapped, every worker hashes its blocks straight from the page cache.
+	FExportPakMappedFile MappedFile;
+	if (MappedFile.Open(PakFilepath) && MappedFile.GetSize() == OutDigest.FileSize)
+	{
+		ParallelFor(NumBlocks, [&OutDigest, &MappedFile](int32 BlockIndex)
+		{
+			const int64 Offset = BlockIndex * OutDigest.BlockSize;
+			const int64 Size = FMath::Min(OutDigest.BlockSize, OutDigest.FileSize - Offset);
+			FSHA1::HashBuffer(MappedFile.GetData() + Offset, (uint32)Size, OutDigest.BlockHashes[BlockIndex].Hash);
+		});
+	}
+	else
+	{
+		// Otherwise each worker reads one contiguous range of blocks with its own reader and buffer.
+		const int32 NumRanges = FMath::Min(NumBlocks, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+		FThreadSafeBool bReadFailed(false);
+		ParallelFor(NumRanges, [&OutDigest, &PakFilepath, &bReadFailed, NumBlocks, NumRanges](int32 RangeIndex)
+		{
+			const int32 FirstBlock = (int32)((int64)NumBlocks * RangeIndex / NumRanges);
+			const int32 EndBlock = (int32)((int64)NumBlocks * (RangeIndex + 1) / NumRanges);
+
+			TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*PakFilepath));
+			if (!Reader)
+			{
+				bReadFailed = true;
+				return;
+			}
+
+			TArray<uint8> Buffer;
+			Buffer.SetNumUninitialized((int32)FMath::Min(OutDigest.BlockSize, OutDigest.FileSize));
+			Reader->Seek(FirstBlock * OutDigest.BlockSize);
+			for (int32 BlockIndex = FirstBlock; BlockIndex < EndBlock && !bReadFailed; ++BlockIndex)
+			{
+				const int64 Size = FMath::Min(OutDigest.BlockSize, OutDigest.FileSize - BlockIndex * OutDigest.BlockSize);
+				Reader->Serialize(Buffer.GetData(), Size);
+				if (Reader->IsError())
+				{
+					bReadFailed = true;
+					return;
+				}
+
+				FSHA1::HashBuffer(Buffer.GetData(), (uint32)Size, OutDigest.BlockHashes[BlockIndex].Hash);
+			}
+		});
+
+		if (bReadFailed)
+		{
+			return false;
+		}
+	}
+
+	FSHA1 HashOfBlocks;
+	for (const auto& BlockHash : OutDigest.BlockHashes)
+	{
+		HashOfBlocks.Update(BlockHash.Hash, sizeof(BlockHash.Hash));
+	}
+	HashOfBlocks.Final();
+	HashOfBlocks.GetHash(OutDigest.HashOfBlocks.Hash);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakVerifierTest, "ExportPak.Verifier", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakVerifierTest::RunTest(const FString& Parameters)
+{
+	FString TestDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/VerifierTest")));
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	TArray<FExportPakFileEntry> Files;
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		TArray<uint8> Content;
+		Content.SetNumUninitialized(1000 + Index * 700);
+		for (int32 ByteIndex = 0; ByteIndex < Content.Num(); ++ByteIndex)
+		{
+			Content[ByteIndex] = static_cast<uint8>((ByteIndex * 17 + Index) & 0xFF);
+		}
+
+		FString SourceFilepath = FPaths::Combine(TestDirectory, FString::Printf(TEXT("Source/File%d.uasset"), Index));
+		FFileHelper::SaveArrayToFile(Content, *SourceFilepath);
+		Files.Add(FExportPakFileEntry(SourceFilepath, FString::Printf(TEXT("../../../MyProject/Content/Test/File%d.uasset"), Index), Content.Num()));
+	}
+
+	FString PakFilepath = FPaths::Combine(TestDirectory, TEXT("Test.pak"));
+	FExportPakWriter Writer(PakFilepath, FExportPakWriterOptions());
+	TestTrue(TEXT("Pak written"), Writer.Write(Files));
+
+	FExportPakVerification Verification;
+	TestTrue(TEXT("Pak has the files it was made from"), FExportPakVerifier::CheckEntries(PakFilepath, Files, Verification));
+
+	TArray<FExportPakFileEntry> OtherFiles = Files;
+	OtherFiles[0].Size += 1;
+	OtherFiles.RemoveAt(1);
+	OtherFiles.Add(FExportPakFileEntry(TEXT("Missing.uasset"), TEXT("../../../MyProject/Content/Test/Missing.uasset")));
+	TestFalse(TEXT("Pak differs from other files"), FExportPakVerifier::CheckEntries(PakFilepath, OtherFiles, Verification));
+	TestTrue(TEXT("Missing files"), Verification.MissingFiles == TArray<FString>({ TEXT("../../../MyProject/Content/Test/Missing.uasset") }));
+	TestTrue(TEXT("Unexpected files"), Verification.UnexpectedFiles == TArray<FString>({ TEXT("../../../MyProject/Content/Test/File1.uasset") }));
+	TestTrue(TEXT("Mismatched files"), Verification.MismatchedFiles == TArray<FString>({ TEXT("../../../MyProject/Content/Test/File0.uasset") }));
+
+	TestFalse(TEXT("No pak"), FExportPakVerifier::CheckEntries(FPaths::Combine(TestDirectory, TEXT("None.pak")), Files, Verification));
+	TestFalse(TEXT("No pak is not readable"), Verification.bPakReadable);
+
+	// A block size that does not divide the pak, so the last block is shorter.
+	const int64 BlockSize = 1000;
+	FExportPakDigest Digest;
+	TestTrue(TEXT("Digest computed"), FExportPakVerifier::ComputeDigest(PakFilepath, BlockSize, Digest));
+
+	TArray<uint8> PakContent;
+	FFileHelper::LoadFileToArray(PakContent, *PakFilepath);
+	TestEqual(TEXT("File size"), Digest.FileSize, (int64)PakContent.Num());
+	TestEqual(TEXT("Number of blocks"), Digest.BlockHashes.Num(), (int32)((PakContent.Num() + BlockSize - 1) / BlockSize));
+	TestTrue(TEXT("Last block is shorter"), PakContent.Num() % BlockSize != 0);
+
+	FSHA1 ExpectedHashOfBlocks;
+	for (int32 BlockIndex = 0; BlockIndex < Digest.BlockHashes.Num(); ++BlockIndex)
+	{
+		const int64 Offset = BlockIndex * BlockSize;
+		FSHAHash ExpectedBlockHash;
+		FSHA1::HashBuffer(PakContent.GetData() + Offset, (uint32)FMath::Min<int64>(BlockSize, PakContent.Num() - Offset), ExpectedBlockHash.Hash);
+		TestTrue(TEXT("Block hash"), Digest.BlockHashes[BlockIndex] == ExpectedBlockHash);
+		ExpectedHashOfBlocks.Update(ExpectedBlockHash.Hash, sizeof(ExpectedBlockHash.Hash));
+	}
+	ExpectedHashOfBlocks.Final();
+	FSHAHash ExpectedHash;
+	ExpectedHashOfBlocks.GetHash(ExpectedHash.Hash);
+	TestTrue(TEXT("Hash of blocks"), Digest.HashOfBlocks == ExpectedHash);
+
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	return true;
+}
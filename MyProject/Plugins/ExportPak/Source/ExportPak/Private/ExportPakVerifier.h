@@ -0,0 +1,67 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+
+struct FExportPakFileEntry;
+
+/**
+ * SHA1 digests of a pak file. The file is hashed in fixed size blocks so all cores can hash it at once,
+ * and so a download client can check every block as it arrives instead of rehashing the whole pak at the end.
+ */
+struct FExportPakDigest
+{
+	FExportPakDigest()
+		:
+		FileSize(0),
+		BlockSize(0)
+	{
+	}
+
+	int64 FileSize;
+
+	int64 BlockSize;
+
+	/** SHA1 of every BlockSize range of the file, the last block may be shorter. */
+	TArray<FSHAHash> BlockHashes;
+
+	/** SHA1 of the block hashes one after the other, a single value that covers the whole file. */
+	FSHAHash HashOfBlocks;
+};
+
+/** How the entries of a pak compare to the cooked files that were meant to go into it. */
+struct FExportPakVerification
+{
+	FExportPakVerification()
+		:
+		bPakReadable(false)
+	{
+	}
+
+	bool IsValid() const
+	{
+		return bPakReadable && MissingFiles.Num() == 0 && UnexpectedFiles.Num() == 0 && MismatchedFiles.Num() == 0;
+	}
+
+	/** False if the pak does not exist or its index cannot be read. */
+	bool bPakReadable;
+
+	/** Paths inside the pak, sorted. */
+	TArray<FString> MissingFiles;
+	TArray<FString> UnexpectedFiles;
+
+	/** Entries whose uncompressed size is not the size of their cooked file. */
+	TArray<FString> MismatchedFiles;
+};
+
+class FExportPakVerifier
+{
+public:
+	/** Open the pak and check its entry list against the files it was created from. Returns Out.IsValid(). */
+	static bool CheckEntries(const FString& PakFilepath, const TArray<FExportPakFileEntry>& ExpectedFiles, FExportPakVerification& OutVerification);
+
+	/** Hash the pak in blocks of BlockSize on all cores. Returns false if the file cannot be read. */
+	static bool ComputeDigest(const FString& PakFilepath, int64 BlockSize, FExportPakDigest& OutDigest);
+};
@@ -0,0 +1,653 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakWriter.h"
+#include "ExportPak.h"
+#include "IPlatformFilePak.h"
+#include "Misc/SecureHash.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Serialization/MemoryWriter.h"
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "Templates/UniquePtr.h"
+
+namespace ExportPakWriter
+{
+	/** Size of the chunks cooked files are streamed in. */
+	static const int64 CopyBufferSize = 1024 * 1024;
+
+	/** Most bytes of a file read and compressed in parallel at once, bounds the memory of every writer. */
+	static const int64 MaxCompressionBatchSize = 8 * 1024 * 1024;
+
+	/** Smaller raw files are cheaper to stream through the copy buffer than to map. */
+	static const int64 MinZeroCopySize = 256 * 1024;
+}
+
+FExportPakWriter::FExportPakWriter(const FString& InPakFilepath, const FExportPakWriterOptions& InOptions)
+	:
+	PakFilepath(InPakFilepath),
+	Options(InOptions),
+	ZeroCopiedSize(0),
+	PakEndOffset(0)
+{
+}
+
+FString FExportPakWriter::GetCommonMountPoint(const TArray<FExportPakFileEntry>& Files)
+{
+	if (Files.Num() == 0)
+	{
+		return FString();
+	}
+
+	FString MountPoint = FPaths::GetPath(Files[0].DestFilepath) + TEXT("/");
+	for (const auto& File : Files)
+	{
+		while (!MountPoint.IsEmpty() && !File.DestFilepath.StartsWith(MountPoint, ESearchCase::CaseSensitive))
+		{
+			FString ParentPath = FPaths::GetPath(MountPoint.LeftChop(1));
+			MountPoint = ParentPath.IsEmpty() ? FString() : ParentPath + TEXT("/");
+		}
+	}
+
+	return MountPoint;
+}
+
+void FExportPakWriter::WritePadding(FArchive& PakArchive, int64 EntrySize)
+{
+	const int64 PadAlign = Options.PatchPaddingAlign;
+	if (PadAlign <= 0 || EntrySize > PadAlign)
+	{
+		return;
+	}
+
+	const int64 EntryStart = PakArchive.Tell();
+	if (EntryStart / PadAlign == (EntryStart + EntrySize - 1) / PadAlign)
+	{
+		return;
+	}
+
+	int64 PaddingSize = Align(EntryStart, PadAlign) - EntryStart;
+	TArray<uint8> Padding;
+	Padding.SetNumZeroed(PaddingSize);
+	PakArchive.Serialize(Padding.GetData(), Padding.Num());
+}
+
+bool FExportPakWriter::WriteEntry(FArchive& PakArchive, const FExportPakFileEntry& File, FPakEntry& OutEntry)
+{
+	TUniquePtr<FArchive> SourceArchive(IFileManager::Get().CreateFileReader(*File.SourceFilepath));
+	if (!SourceArchive)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to open cooked file %s"), *File.SourceFilepath);
+		return false;
+	}
+
+	const int64 FileSize = SourceArchive->TotalSize();
+
+	const ECompressionFlags CompressionMethod = (ECompressionFlags)File.CompressionMethod;
+	if (CompressionMethod != COMPRESS_None && FileSize > 0)
+	{
+		bool bCompressed = false;
+		if (!WriteCompressedEntry(PakArchive, *SourceArchive, File, CompressionMethod, OutEntry, bCompressed))
+		{
+			return false;
+		}
+
+		if (bCompressed)
+		{
+			return true;
+		}
+		SourceArchive->Seek(0);
+	}
+
+	OutEntry.Size = FileSize;
+	OutEntry.UncompressedSize = FileSize;
+	OutEntry.CompressionMethod = COMPRESS_None;
+	OutEntry.bEncrypted = false;
+
+	if (CopyTarget.IsOpen() && FileSize >= ExportPakWriter::MinZeroCopySize)
+	{
+		FExportPakMappedFile MappedFile;
+		if (MappedFile.Open(File.SourceFilepath) && MappedFile.GetSize() == FileSize)
+		{
+			return WriteMappedEntry(PakArchive, MappedFile, OutEntry);
+		}
+	}
+
+	const int32 Version = FPakInfo::PakFile_Version_Latest;
+	WritePadding(PakArchive, OutEntry.GetSerializedSize(Version) + FileSize);
+
+	// The header inside the data section never carries an offset, the index does.
+	// The hash is not known yet, so a placeholder header is written and patched after the data.
+	const int64 HeaderOffset = PakArchive.Tell();
+	OutEntry.Offset = 0;
+	OutEntry.Serialize(PakArchive, Version);
+
+	FSHA1 Hasher;
+	int64 RemainingSize = FileSize;
+	while (RemainingSize > 0)
+	{
+		const int64 SizeToCopy = FMath::Min(RemainingSize, ExportPakWriter::CopyBufferSize);
+		SourceArchive->Serialize(CopyBuffer.GetData(), SizeToCopy);
+		if (SourceArchive->IsError())
+		{
+			UE_LOG(LogExportPak, Error, TEXT("Failed to read cooked file %s"), *File.SourceFilepath);
+			return false;
+		}
+
+		Hasher.Update(CopyBuffer.GetData(), SizeToCopy);
+		PakArchive.Serialize(CopyBuffer.GetData(), SizeToCopy);
+		RemainingSize -= SizeToCopy;
+	}
+	Hasher.Final();
+	Hasher.GetHash(OutEntry.Hash);
+
+	const int64 DataEndOffset = PakArchive.Tell();
+	PakArchive.Seek(HeaderOffset);
+	OutEntry.Serialize(PakArchive, Version);
+	PakArchive.Seek(DataEndOffset);
+
+	OutEntry.Offset = HeaderOffset;
+
+	return !PakArchive.IsError();
+}
+
+bool FExportPakWriter::WriteMappedEntry(FArchive& PakArchive, const FExportPakMappedFile& MappedFile, FPakEntry& OutEntry)
+{
+	const int64 FileSize = MappedFile.GetSize();
+
+	// The mapping is hashed in place, so the header is right the first time.
+	FSHA1 Hasher;
+	for (int64 HashedSize = 0; HashedSize < FileSize; HashedSize += ExportPakWriter::CopyBufferSize)
+	{
+		Hasher.Update(MappedFile.GetData() + HashedSize, (uint32)FMath::Min(FileSize - HashedSize, ExportPakWriter::CopyBufferSize));
+	}
+	Hasher.Final();
+	Hasher.GetHash(OutEntry.Hash);
+
+	const int32 Version = FPakInfo::PakFile_Version_Latest;
+	WritePadding(PakArchive, OutEntry.GetSerializedSize(Version) + FileSize);
+
+	const int64 HeaderOffset = PakArchive.Tell();
+	OutEntry.Offset = 0;
+	OutEntry.Serialize(PakArchive, Version);
+
+	// The data goes in through the other descriptor, what the archive still buffers has to be in the file first.
+	PakArchive.Flush();
+	const int64 DataOffset = PakArchive.Tell();
+
+	EExportPakCopyMethod CopyMethod = EExportPakCopyMethod::MappedWrite;
+	if (!CopyTarget.CopyFrom(MappedFile, DataOffset, CopyMethod))
+	{
+		return false;
+	}
+	PakArchive.Seek(DataOffset + FileSize);
+	ZeroCopiedSize += FileSize;
+
+	OutEntry.Offset = HeaderOffset;
+
+	return !PakArchive.IsError();
+}
+
+bool FExportPakWriter::CompressBatch(FArchive& SourceArchive, const FExportPakFileEntry& File, int64 BatchSize, ECompressionFlags CompressionMethod)
+{
+	const int64 BlockSize = Options.CompressionBlockSize;
+	const int32 NumBatchBlocks = (int32)((BatchSize + BlockSize - 1) / BlockSize);
+
+	SourceArchive.Serialize(CopyBuffer.GetData(), BatchSize);
+	if (SourceArchive.IsError())
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to read cooked file %s"), *File.SourceFilepath);
+		return false;
+	}
+
+	// Blocks are independent, each worker only touches its own output.
+	FThreadSafeCounter NumFailedBlocks;
+	ParallelFor(NumBatchBlocks, [this, BlockSize, BatchSize, CompressionMethod, &NumFailedBlocks](int32 BlockIndex)
+	{
+		const int64 BlockOffset = BlockIndex * BlockSize;
+		const int32 UncompressedBlockSize = (int32)FMath::Min<int64>(BatchSize - BlockOffset, BlockSize);
+
+		TArray<uint8>& CompressedBlock = CompressedBatchBlocks[BlockIndex];
+		int32 CompressedBlockSize = FCompression::CompressMemoryBound(CompressionMethod, UncompressedBlockSize);
+		CompressedBlock.SetNumUninitialized(CompressedBlockSize, false);
+		if (FCompression::CompressMemory(CompressionMethod, CompressedBlock.GetData(), CompressedBlockSize, CopyBuffer.GetData() + BlockOffset, UncompressedBlockSize))
+		{
+			CompressedBlock.SetNum(CompressedBlockSize, false);
+		}
+		else
+		{
+			NumFailedBlocks.Increment();
+		}
+	}, NumBatchBlocks == 1);
+
+	if (NumFailedBlocks.GetValue() > 0)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to compress cooked file %s"), *File.SourceFilepath);
+		return false;
+	}
+
+	return true;
+}
+
+bool FExportPakWriter::WriteCompressedEntry(FArchive& PakArchive, FArchive& SourceArchive, const FExportPakFileEntry& File, ECompressionFlags CompressionMethod, FPakEntry& OutEntry, bool& bOutCompressed)
+{
+	bOutCompressed = false;
+
+	const int32 Version = FPakInfo::PakFile_Version_Latest;
+	const int64 FileSize = SourceArchive.TotalSize();
+	const int64 BlockSize = Options.CompressionBlockSize;
+	const int32 NumBlocksPerBatch = Options.bParallelCompression ? (int32)FMath::Max<int64>(ExportPakWriter::MaxCompressionBatchSize / BlockSize, 1) : 1;
+	const int64 MaxBatchSize = NumBlocksPerBatch * BlockSize;
+
+	if (CopyBuffer.Num() < FMath::Min(FileSize, MaxBatchSize))
+	{
+		CopyBuffer.SetNumUninitialized(FMath::Min(FileSize, MaxBatchSize), false);
+	}
+	if (CompressedBatchBlocks.Num() < NumBlocksPerBatch)
+	{
+		CompressedBatchBlocks.SetNum(NumBlocksPerBatch);
+	}
+
+	OutEntry.UncompressedSize = FileSize;
+	OutEntry.CompressionMethod = CompressionMethod;
+	OutEntry.CompressionBlockSize = (uint32)FMath::Min<int64>(FileSize, BlockSize);
+	OutEntry.bEncrypted = false;
+	OutEntry.CompressionBlocks.SetNum((FileSize + BlockSize - 1) / BlockSize);
+
+	// The size of the header only depends on the number of blocks, so it is known before any block is compressed.
+	const int64 HeaderSize = OutEntry.GetSerializedSize(Version);
+
+	// Blocks are held back only while the entry may still be small enough to be padded.
+	// After that a placeholder header is written and every batch goes straight into the pak.
+	const int64 EntryStart = PakArchive.Tell();
+	int64 HeaderOffset = INDEX_NONE;
+	CompressedData.Reset();
+
+	FSHA1 Hasher;
+	int64 CompressedSize = 0;
+	int32 BlockIndex = 0;
+	for (int64 BatchOffset = 0; BatchOffset < FileSize; BatchOffset += MaxBatchSize)
+	{
+		const int64 BatchSize = FMath::Min(FileSize - BatchOffset, MaxBatchSize);
+		if (!CompressBatch(SourceArchive, File, BatchSize, CompressionMethod))
+		{
+			return false;
+		}
+
+		// In file order, whichever block finished first. Offsets are relative to the data until the header is placed.
+		const int32 NumBatchBlocks = (int32)((BatchSize + BlockSize - 1) / BlockSize);
+		for (int32 BatchBlockIndex = 0; BatchBlockIndex < NumBatchBlocks; ++BatchBlockIndex)
+		{
+			TArray<uint8>& CompressedBlock = CompressedBatchBlocks[BatchBlockIndex];
+
+			FPakCompressedBlock& Block = OutEntry.CompressionBlocks[BlockIndex++];
+			Block.CompressedStart = CompressedSize;
+			Block.CompressedEnd = CompressedSize + CompressedBlock.Num();
+			CompressedSize += CompressedBlock.Num();
+
+			// The hash covers the data as stored, which is what the pak reader checks.
+			Hasher.Update(CompressedBlock.GetData(), CompressedBlock.Num());
+
+			if (HeaderOffset == INDEX_NONE)
+			{
+				CompressedData.Append(CompressedBlock);
+			}
+			else
+			{
+				PakArchive.Serialize(CompressedBlock.GetData(), CompressedBlock.Num());
+			}
+		}
+
+		if (HeaderOffset == INDEX_NONE && (Options.PatchPaddingAlign <= 0 || HeaderSize + CompressedSize > Options.PatchPaddingAlign))
+		{
+			HeaderOffset = PakArchive.Tell();
+			OutEntry.Offset = 0;
+			OutEntry.Serialize(PakArchive, Version);
+			PakArchive.Serialize(CompressedData.GetData(), CompressedData.Num());
+			CompressedData.Reset();
+		}
+	}
+
+	// Like UnrealPak, a file that does not get smaller is stored raw, over what was written here.
+	if (CompressedSize >= FileSize)
+	{
+		PakEndOffset = FMath::Max(PakEndOffset, PakArchive.Tell());
+		PakArchive.Seek(EntryStart);
+		OutEntry.CompressionBlocks.Empty();
+		OutEntry.CompressionBlockSize = 0;
+		return !PakArchive.IsError();
+	}
+
+	if (HeaderOffset == INDEX_NONE)
+	{
+		WritePadding(PakArchive, HeaderSize + CompressedSize);
+		HeaderOffset = PakArchive.Tell();
+		OutEntry.Offset = 0;
+		OutEntry.Serialize(PakArchive, Version);
+		PakArchive.Serialize(CompressedData.GetData(), CompressedData.Num());
+		CompressedData.Reset();
+	}
+
+	// Up to IndexEncryption, the newest version of 4.18, the reader takes block offsets as positions in the pak.
+	const int64 DataOffset = HeaderOffset + HeaderSize;
+	for (auto& Block : OutEntry.CompressionBlocks)
+	{
+		Block.CompressedStart += DataOffset;
+		Block.CompressedEnd += DataOffset;
+	}
+	OutEntry.Size = CompressedSize;
+	Hasher.Final();
+	Hasher.GetHash(OutEntry.Hash);
+
+	const int64 DataEndOffset = PakArchive.Tell();
+	PakArchive.Seek(HeaderOffset);
+	OutEntry.Serialize(PakArchive, Version);
+	PakArchive.Seek(DataEndOffset);
+
+	OutEntry.Offset = HeaderOffset;
+	bOutCompressed = true;
+
+	return !PakArchive.IsError();
+}
+
+bool FExportPakWriter::Write(const TArray<FExportPakFileEntry>& Files)
+{
+	FString MountPoint = GetCommonMountPoint(Files);
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(PakFilepath), true);
+	TUniquePtr<FArchive> PakArchive(IFileManager::Get().CreateFileWriter(*PakFilepath));
+	if (!PakArchive)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to create pak file %s"), *PakFilepath);
+		return false;
+	}
+
+	// WriteCompressedEntry() grows it when a batch of blocks needs more.
+	CopyBuffer.SetNumUninitialized(ExportPakWriter::CopyBufferSize, false);
+
+	ZeroCopiedSize = 0;
+	PakEndOffset = 0;
+	if (Options.bZeroCopy)
+	{
+		CopyTarget.Open(PakFilepath);
+	}
+
+	TArray<FPakEntry> Entries;
+	Entries.SetNum(Files.Num());
+
+	bool bSuccess = true;
+	for (int32 Index = 0; Index < Files.Num() && bSuccess; ++Index)
+	{
+		bSuccess = WriteEntry(*PakArchive, Files[Index], Entries[Index]);
+	}
+
+	if (bSuccess)
+	{
+		const int32 Version = FPakInfo::PakFile_Version_Latest;
+
+		// A compressed attempt stored raw after all may have written past the last entry, FPakInfo has to end the file.
+		if (PakArchive->Tell() < PakEndOffset)
+		{
+			TArray<uint8> Padding;
+			Padding.SetNumZeroed(PakEndOffset - PakArchive->Tell());
+			PakArchive->Serialize(Padding.GetData(), Padding.Num());
+		}
+
+		TArray<uint8> IndexData;
+		FMemoryWriter IndexWriter(IndexData);
+		IndexWriter << MountPoint;
+
+		int32 NumEntries = Entries.Num();
+		IndexWriter << NumEntries;
+		for (int32 Index = 0; Index < Entries.Num(); ++Index)
+		{
+			FString Filename = Files[Index].DestFilepath.Mid(MountPoint.Len());
+			IndexWriter << Filename;
+			Entries[Index].Serialize(IndexWriter, Version);
+		}
+
+		FPakInfo Info;
+		Info.IndexOffset = PakArchive->Tell();
+		Info.IndexSize = IndexData.Num();
+		FSHA1::HashBuffer(IndexData.GetData(), IndexData.Num(), Info.IndexHash);
+
+		PakArchive->Serialize(IndexData.GetData(), IndexData.Num());
+		Info.Serialize(*PakArchive);
+
+		bSuccess = !PakArchive->IsError();
+	}
+
+	bSuccess = PakArchive->Close() && bSuccess;
+	PakArchive.Reset();
+	CopyTarget.Close();
+
+	if (ZeroCopiedSize > 0)
+	{
+		UE_LOG(LogExportPak, Verbose, TEXT("%s: %lld byte(s) copied without the copy buffer."), *PakFilepath, ZeroCopiedSize);
+	}
+
+	if (!bSuccess)
+	{
+		UE_LOG(LogExportPak, Error, TEXT("Failed to write pak file %s"), *PakFilepath);
+		IFileManager::Get().Delete(*PakFilepath);
+	}
+
+	return bSuccess;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakWriterRoundTripTest, "ExportPak.PakWriter.RoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakWriterRoundTripTest::RunTest(const FString& Parameters)
+{
+	FString TestDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/PakWriterTest")));
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	// Sizes chosen to cover an empty file, a padded small file and one larger than the copy buffer.
+	const int64 FileSizes[] = { 0, 100, 2000, 3 * ExportPakWriter::CopyBufferSize + 17 };
+
+	TArray<FExportPakFileEntry> Files;
+	TArray<TArray<uint8>> FileContents;
+	for (int32 Index = 0; Index < ARRAY_COUNT(FileSizes); ++Index)
+	{
+		FileContents.AddDefaulted();
+		TArray<uint8>& Content = FileContents.Last();
+		Content.SetNumUninitialized(FileSizes[Index]);
+		for (int64 ByteIndex = 0; ByteIndex < FileSizes[Index]; ++ByteIndex)
+		{
+			Content[ByteIndex] = static_cast<uint8>((ByteIndex * 31 + Index) & 0xFF);
+		}
+
+		FString SourceFilepath = FPaths::Combine(TestDirectory, FString::Printf(TEXT("Source/File%d.uasset"), Index));
+		FFileHelper::SaveArrayToFile(Content, *SourceFilepath);
+		Files.Add(FExportPakFileEntry(SourceFilepath, FString::Printf(TEXT("../../../MyProject/Content/Test/Sub%d/File%d.uasset"), Index % 2, Index)));
+	}
+
+	FString PakFilepath = FPaths::Combine(TestDirectory, TEXT("Test.pak"));
+	FExportPakWriter Writer(PakFilepath, FExportPakWriterOptions());
+	TestTrue(TEXT("Pak written"), Writer.Write(Files));
+
+	FPakFile PakFile(&FPlatformFileManager::Get().GetPlatformFile(), *PakFilepath, false);
+	TestTrue(TEXT("Pak is valid"), PakFile.IsValid());
+	TestEqual(TEXT("Mount point"), PakFile.GetMountPoint(), FString(TEXT("../../../MyProject/Content/Test/")));
+
+	TUniquePtr<FArchive> PakReader(IFileManager::Get().CreateFileReader(*PakFilepath));
+	int32 NumFound = 0;
+	for (FPakFile::FFileIterator It(PakFile); It; ++It, ++NumFound)
+	{
+		const int32 Index = Files.IndexOfByPredicate([&It](const FExportPakFileEntry& File)
+		{
+			return File.DestFilepath.EndsWith(It.Filename());
+		});
+		if (Index == INDEX_NONE)
+		{
+			AddError(FString::Printf(TEXT("Unexpected entry %s"), *It.Filename()));
+			continue;
+		}
+
+		const FPakEntry& IndexEntry = It.Info();
+		TestEqual(TEXT("Entry size"), IndexEntry.Size, FileSizes[Index]);
+
+		PakReader->Seek(IndexEntry.Offset);
+		FPakEntry InlineEntry;
+		InlineEntry.Serialize(*PakReader, PakFile.GetInfo().Version);
+		TestTrue(TEXT("Inline header matches index"), InlineEntry.Size == IndexEntry.Size && FMemory::Memcmp(InlineEntry.Hash, IndexEntry.Hash, sizeof(IndexEntry.Hash)) == 0);
+
+		TArray<uint8> Data;
+		Data.SetNumUninitialized(IndexEntry.Size);
+		PakReader->Serialize(Data.GetData(), Data.Num());
+		TestTrue(TEXT("Entry data round-trips"), Data == FileContents[Index]);
+	}
+	TestEqual(TEXT("Entry count"), NumFound, Files.Num());
+
+	PakReader.Reset();
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakWriterCompressionTest, "ExportPak.PakWriter.Compression", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakWriterCompressionTest::RunTest(const FString& Parameters)
+{
+	FString TestDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/PakWriterCompressionTest")));
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	FExportPakWriterOptions Options;
+	Options.CompressionBlockSize = 64 * 1024;
+
+	// More than one parallel batch with a partial last block, and a file that does not compress and has to stay raw.
+	// The raw file comes last, so the pak only stays valid if nothing of its compressed attempt is left after the index.
+	TArray<uint8> CompressibleContent;
+	CompressibleContent.SetNumUninitialized(ExportPakWriter::MaxCompressionBatchSize + 5 * Options.CompressionBlockSize / 2);
+	const int32 ExpectedNumBlocks = (CompressibleContent.Num() + Options.CompressionBlockSize - 1) / Options.CompressionBlockSize;
+	for (int32 ByteIndex = 0; ByteIndex < CompressibleContent.Num(); ++ByteIndex)
+	{
+		CompressibleContent[ByteIndex] = static_cast<uint8>((ByteIndex / 7) & 0x0F);
+	}
+
+	TArray<uint8> RandomContent;
+	RandomContent.SetNumUninitialized(3000);
+	FRandomStream RandomStream(42);
+	for (auto& Byte : RandomContent)
+	{
+		Byte = static_cast<uint8>(RandomStream.RandHelper(256));
+	}
+
+	TArray<FExportPakFileEntry> Files;
+	Files.Add(FExportPakFileEntry(FPaths::Combine(TestDirectory, TEXT("Source/Compressible.uasset")), TEXT("../../../MyProject/Content/Test/Compressible.uasset")));
+	Files.Add(FExportPakFileEntry(FPaths::Combine(TestDirectory, TEXT("Source/Random.uasset")), TEXT("../../../MyProject/Content/Test/Random.uasset")));
+	FFileHelper::SaveArrayToFile(CompressibleContent, *Files[0].SourceFilepath);
+	FFileHelper::SaveArrayToFile(RandomContent, *Files[1].SourceFilepath);
+	for (auto& File : Files)
+	{
+		File.CompressionMethod = COMPRESS_ZLIB;
+	}
+
+	FString PakFilepath = FPaths::Combine(TestDirectory, TEXT("Test.pak"));
+	FExportPakWriter Writer(PakFilepath, Options);
+	TestTrue(TEXT("Pak written"), Writer.Write(Files));
+
+	FPakFile PakFile(&FPlatformFileManager::Get().GetPlatformFile(), *PakFilepath, false);
+	TestTrue(TEXT("Pak is valid"), PakFile.IsValid());
+
+	TUniquePtr<FArchive> PakReader(IFileManager::Get().CreateFileReader(*PakFilepath));
+	for (FPakFile::FFileIterator It(PakFile); It; ++It)
+	{
+		const FPakEntry& Entry = It.Info();
+		if (It.Filename().EndsWith(TEXT("Random.uasset")))
+		{
+			TestEqual(TEXT("Incompressible file stays raw"), Entry.CompressionMethod, (int32)COMPRESS_None);
+			continue;
+		}
+
+		TestEqual(TEXT("Compression method"), Entry.CompressionMethod, (int32)COMPRESS_ZLIB);
+		TestTrue(TEXT("Stored smaller than raw"), Entry.Size < Entry.UncompressedSize);
+		TestEqual(TEXT("Number of blocks"), Entry.CompressionBlocks.Num(), ExpectedNumBlocks);
+		TestTrue(TEXT("Blocks are at absolute offsets after the header"), Entry.CompressionBlocks[0].CompressedStart == Entry.Offset + Entry.GetSerializedSize(PakFile.GetInfo().Version));
+
+		TArray<uint8> Data;
+		Data.SetNumUninitialized(Entry.UncompressedSize);
+		int64 UncompressedOffset = 0;
+		for (const auto& Block : Entry.CompressionBlocks)
+		{
+			TArray<uint8> CompressedBlock;
+			CompressedBlock.SetNumUninitialized(Block.CompressedEnd - Block.CompressedStart);
+			PakReader->Seek(Block.CompressedStart);
+			PakReader->Serialize(CompressedBlock.GetData(), CompressedBlock.Num());
+
+			const int32 UncompressedBlockSize = (int32)FMath::Min<int64>(Entry.CompressionBlockSize, Entry.UncompressedSize - UncompressedOffset);
+			TestTrue(TEXT("Block decompresses"), FCompression::UncompressMemory(COMPRESS_ZLIB, Data.GetData() + UncompressedOffset, UncompressedBlockSize, CompressedBlock.GetData(), CompressedBlock.Num()));
+			UncompressedOffset += UncompressedBlockSize;
+		}
+		TestTrue(TEXT("Entry data round-trips"), Data == CompressibleContent);
+	}
+	PakReader.Reset();
+
+	// Blocks are written in file order, so compressing them in parallel must not change a byte.
+	FExportPakWriterOptions SerialOptions = Options;
+	SerialOptions.bParallelCompression = false;
+
+	FString SerialPakFilepath = FPaths::Combine(TestDirectory, TEXT("Serial.pak"));
+	FExportPakWriter SerialWriter(SerialPakFilepath, SerialOptions);
+	TestTrue(TEXT("Serial pak written"), SerialWriter.Write(Files));
+
+	TArray<uint8> ParallelPakData;
+	TArray<uint8> SerialPakData;
+	FFileHelper::LoadFileToArray(ParallelPakData, *PakFilepath);
+	FFileHelper::LoadFileToArray(SerialPakData, *SerialPakFilepath);
+	TestTrue(TEXT("Parallel and serial compression give the same pak"), ParallelPakData == SerialPakData);
+
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FExportPakWriterZeroCopyTest, "ExportPak.PakWriter.ZeroCopy", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FExportPakWriterZeroCopyTest::RunTest(const FString& Parameters)
+{
+	FString TestDirectory = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp/PakWriterZeroCopyTest")));
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	// Small files stay on the copy buffer between the large ones, so both paths write into the same pak.
+	const int64 FileSizes[] = { 5 * ExportPakWriter::MinZeroCopySize + 3, 100, 2 * ExportPakWriter::CopyBufferSize + 4097, 2000 };
+
+	TArray<FExportPakFileEntry> Files;
+	for (int32 Index = 0; Index < ARRAY_COUNT(FileSizes); ++Index)
+	{
+		TArray<uint8> Content;
+		Content.SetNumUninitialized(FileSizes[Index]);
+		for (int64 ByteIndex = 0; ByteIndex < FileSizes[Index]; ++ByteIndex)
+		{
+			Content[ByteIndex] = static_cast<uint8>((ByteIndex * 13 + Index) & 0xFF);
+		}
+
+		FString SourceFilepath = FPaths::Combine(TestDirectory, FString::Printf(TEXT("Source/File%d.ubulk"), Index));
+		FFileHelper::SaveArrayToFile(Content, *SourceFilepath);
+		Files.Add(FExportPakFileEntry(SourceFilepath, FString::Printf(TEXT("../../../MyProject/Content/Test/File%d.ubulk"), Index)));
+	}
+
+	FString ZeroCopyPakFilepath = FPaths::Combine(TestDirectory, TEXT("ZeroCopy.pak"));
+	FExportPakWriter ZeroCopyWriter(ZeroCopyPakFilepath, FExportPakWriterOptions());
+	TestTrue(TEXT("Zero-copy pak written"), ZeroCopyWriter.Write(Files));
+
+	FExportPakWriterOptions BufferedOptions;
+	BufferedOptions.bZeroCopy = false;
+
+	FString BufferedPakFilepath = FPaths::Combine(TestDirectory, TEXT("Buffered.pak"));
+	FExportPakWriter BufferedWriter(BufferedPakFilepath, BufferedOptions);
+	TestTrue(TEXT("Buffered pak written"), BufferedWriter.Write(Files));
+
+	FPakFile PakFile(&FPlatformFileManager::Get().GetPlatformFile(), *ZeroCopyPakFilepath, false);
+	TestTrue(TEXT("Zero-copy pak is valid"), PakFile.IsValid());
+
+	TArray<uint8> ZeroCopyPakData;
+	TArray<uint8> BufferedPakData;
+	FFileHelper::LoadFileToArray(ZeroCopyPakData, *ZeroCopyPakFilepath);
+	FFileHelper::LoadFileToArray(BufferedPakData, *BufferedPakFilepath);
+	TestTrue(TEXT("Zero-copy and buffered writes give the same pak"), ZeroCopyPakData == BufferedPakData);
+
+	IFileManager::Get().DeleteDirectory(*TestDirectory, false, true);
+
+	return true;
+}
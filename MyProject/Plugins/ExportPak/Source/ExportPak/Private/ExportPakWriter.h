@@ -0,0 +1,125 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Compression.h"
+#include "ExportPakFileCopy.h"
+
+struct FPakEntry;
+
+/** A cooked file and the path it is mounted under, the same pair a line of an UnrealPak response file holds. */
+struct FExportPakFileEntry
+{
+	FExportPakFileEntry()
+		:
+		Size(-1),
+		CompressionMethod(COMPRESS_None)
+	{
+	}
+
+	FExportPakFileEntry(const FString& InSourceFilepath, const FString& InDestFilepath, int64 InSize = -1)
+		:
+		SourceFilepath(InSourceFilepath),
+		DestFilepath(InDestFilepath),
+		Size(InSize),
+		CompressionMethod(COMPRESS_None)
+	{
+	}
+
+	/** Absolute path of the cooked file on disk. */
+	FString SourceFilepath;
+
+	/** Path inside the pak, e.g. ../../../MyProject/Content/Maps/NewMap.umap */
+	FString DestFilepath;
+
+	/** Size of the source file when it was discovered, -1 if unknown. Only used for statistics and planning. */
+	int64 Size;
+
+	/** ECompressionFlags the file is stored with, COMPRESS_None keeps it raw. */
+	int32 CompressionMethod;
+};
+
+struct FExportPakWriterOptions
+{
+	FExportPakWriterOptions()
+		:
+		PatchPaddingAlign(2048),
+		CompressionBlockSize(64 * 1024),
+		bParallelCompression(true),
+		bZeroCopy(true)
+	{
+	}
+
+	/** Same as UnrealPak's -patchpaddingalign, entries smaller than this never straddle an alignment boundary. 0 disables padding. */
+	int64 PatchPaddingAlign;
+
+	/** Same as UnrealPak's -compressionblocksize, used by the files with a CompressionMethod. */
+	int32 CompressionBlockSize;
+
+	/** Compress the blocks of a file on the task graph workers. The pak is the same either way. */
+	bool bParallelCompression;
+
+	/**
+	 * Hash large raw files from a mapping and let the kernel copy them into the pak (copy_file_range, sendfile),
+	 * instead of streaming them through the copy buffer. Falls back on its own where that is not available. The pak is the same either way.
+	 */
+	bool bZeroCopy;
+};
+
+/**
+ * Writes a pak file in-process, in the same layout UnrealPak produces:
+ * [entry header, file data]* index FPakInfo.
+ * The FPakEntry/FPakInfo serializers of the PakFile module are used so the engine's pak loader can always mount the result.
+ */
+class FExportPakWriter
+{
+public:
+	FExportPakWriter(const FString& InPakFilepath, const FExportPakWriterOptions& InOptions);
+
+	/** Streams all files into the pak. Logs and returns false on failure, no partial pak is left behind. */
+	bool Write(const TArray<FExportPakFileEntry>& Files);
+
+	/** Longest directory all DestFilepaths share, with a trailing slash. */
+	static FString GetCommonMountPoint(const TArray<FExportPakFileEntry>& Files);
+
+private:
+	bool WriteEntry(FArchive& PakArchive, const FExportPakFileEntry& File, FPakEntry& OutEntry);
+
+	/** Writes a raw entry whose data CopyTarget copies from the mapped cooked file. */
+	bool WriteMappedEntry(FArchive& PakArchive, const FExportPakMappedFile& MappedFile, FPakEntry& OutEntry);
+
+	/** Reads the next BatchSize bytes of the source and compresses them into CompressedBatchBlocks, the blocks in parallel. */
+	bool CompressBatch(FArchive& SourceArchive, const FExportPakFileEntry& File, int64 BatchSize, ECompressionFlags CompressionMethod);
+
+	/**
+	 * Streams the compressed blocks into the pak a batch at a time and patches the header afterwards.
+	 * bOutCompressed is false if the file did not get smaller, the pak is then back where the entry started.
+	 */
+	bool WriteCompressedEntry(FArchive& PakArchive, FArchive& SourceArchive, const FExportPakFileEntry& File, ECompressionFlags CompressionMethod, FPakEntry& OutEntry, bool& bOutCompressed);
+
+	void WritePadding(FArchive& PakArchive, int64 EntrySize);
+
+private:
+	FString PakFilepath;
+
+	FExportPakWriterOptions Options;
+
+	/** Reused for every file so streaming does not allocate per entry. */
+	TArray<uint8> CopyBuffer;
+
+	/** Compressed blocks of the current file held back while it may still need padding, at most PatchPaddingAlign and a batch. */
+	TArray<uint8> CompressedData;
+
+	/** Output of each block of the batch being compressed. */
+	TArray<TArray<uint8>> CompressedBatchBlocks;
+
+	/** Second descriptor of the pak while it is written, only open if bZeroCopy and the platform can do it. */
+	FExportPakCopyTarget CopyTarget;
+
+	/** Bytes of the current pak that did not go through the copy buffer. */
+	int64 ZeroCopiedSize;
+
+	/** Furthest offset written to, a compressed attempt stored raw may end after the raw entry. */
+	int64 PakEndOffset;
+};
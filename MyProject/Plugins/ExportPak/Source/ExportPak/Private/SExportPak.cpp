@@ -12,26 +12,15 @@
 #include "Modules/ModuleManager.h"
 #include "IDetailsView.h"
 #include "ExportPakSettings.h"
+#include "ExportPakExporter.h"
+#include "Widgets/Notifications/SProgressBar.h"
+#include "Widgets/Text/STextBlock.h"
+#include "UObject/Package.h"
+#include "Async/Async.h"
 #include "Framework/Notifications/NotificationManager.h"
 #include "Widgets/Notifications/SNotificationList.h"
-#include "AssetRegistryModule.h"
-#include "ARFilter.h"
-#include "ModuleManager.h"
 #include "ISettingsModule.h"
-#include "PlatformFile.h"
-#include "PlatformFilemanager.h"
-#include "FileHelper.h"
-#include "json.h"
-#include "Misc/SecureHash.h"
-#include "FileManager.h"
-#include "PackageName.h"
-
-struct FDependenciesInfo
-{
-	TArray<FString> DependenciesInGameContentDir;
-	TArray<FString> OtherDependencies;
-	FString AssetClassString;
-};
+#include "Containers/Ticker.h"
 
 
 #define LOCTEXT_NAMESPACE "ExportPak"
@@ -88,13 +77,47 @@ void SExportPak::Construct(const FArguments& InArgs)
 
 					+ SVerticalBox::Slot()
 					.AutoHeight()
-					.HAlign(HAlign_Right)
 					.Padding(4, 4, 10, 4)
 					[
-						SNew(SButton)
-						.Text(LOCTEXT("ExportPak", "Export Pak file(s)"))
-						.OnClicked(this, &SExportPak::OnExportPakButtonClicked)
-						.IsEnabled(this, &SExportPak::CanExportPakExecuted)
+						SNew(SHorizontalBox)
+
+						+ SHorizontalBox::Slot()
+						.FillWidth(1.0f)
+						.VAlign(VAlign_Center)
+						.Padding(0, 0, 8, 0)
+						[
+							SNew(SProgressBar)
+							.Percent(this, &SExportPak::GetExportProgress)
+							.Visibility(this, &SExportPak::GetExportProgressVisibility)
+						]
+
+						+ SHorizontalBox::Slot()
+						.AutoWidth()
+						.VAlign(VAlign_Center)
+						.Padding(0, 0, 8, 0)
+						[
+							SNew(STextBlock)
+							.Text(this, &SExportPak::GetExportStatusText)
+							.Visibility(this, &SExportPak::GetExportProgressVisibility)
+						]
+
+						+ SHorizontalBox::Slot()
+						.AutoWidth()
+						[
+							SNew(SButton)
+							.Text(LOCTEXT("CancelExportPak", "Cancel"))
+							.OnClicked(this, &SExportPak::OnCancelButtonClicked)
+							.Visibility(this, &SExportPak::GetExportProgressVisibility)
+						]
+
+						+ SHorizontalBox::Slot()
+						.AutoWidth()
+						[
+							SNew(SButton)
+							.Text(LOCTEXT("ExportPak", "Export Pak file(s)"))
+							.OnClicked(this, &SExportPak::OnExportPakButtonClicked)
+							.IsEnabled(this, &SExportPak::CanExportPakExecuted)
+						]
 					]
 				]
 			]
@@ -104,9 +127,50 @@ void SExportPak::Construct(const FArguments& InArgs)
 	SettingsView->SetObject(ExportPakSettings);
 }
 
+SExportPak::~SExportPak()
+{
+	if (ExportTickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(ExportTickerHandle);
+		ExportTickerHandle.Reset();
+	}
+
+	// The tab is closing while pak files are being generated, stop them before the settings copy goes away.
+	// Cancel also closes the root queue, so the pak generation does not wait for roots that will never come.
+	if (RunningExporter.IsValid())
+	{
+		RunningExporter->Cancel();
+		RunningExport.Wait();
+		FinishExport();
+	}
+}
+
+bool SExportPak::TickExport(float DeltaTime)
+{
+	if (bWalkingRoots)
+	{
+		WalkRoots();
+	}
+
+	if (RunningExporter.IsValid() && !bWalkingRoots && RunningExport.IsReady())
+	{
+		const bool bSuccess = RunningExport.Get();
+		const bool bCancelled = RunningExporter->GetStatus().bCancelRequested;
+		FinishExport();
+
+		NotifyPakFilesGenerated(bSuccess, bCancelled);
+
+		// Returning false removes the ticker.
+		ExportTickerHandle.Reset();
+		return false;
+	}
+
+	return true;
+}
+
 bool SExportPak::CanExportPakExecuted() const
 {
-	if (ExportPakSettings == nullptr)
+	if (ExportPakSettings == nullptr || RunningExporter.IsValid())
 	{
 		return false;
 	}
@@ -134,575 +198,208 @@ bool SExportPak::CanExportPakExecuted() const
 	return true;
 }
 
-FString HashStringWithSHA1(const FString &InString)
-{
-	FSHAHash StringHash;
-	FSHA1::HashBuffer(TCHAR_TO_ANSI(*InString), InString.Len(), StringHash.Hash);
-
-	return StringHash.ToString();
-}
-
-
-IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHashStringWithSHA1Test, "ExportPak.HashStringWithSHA1", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
-bool FHashStringWithSHA1Test::RunTest(const FString& Parameters)
-{
-	FString S = "/Game/MyProject/Maps/MyTestMap";
-	FString HashString = HashStringWithSHA1(S);
-
-	UE_LOG(LogExportPak, Log, TEXT("%s -> %s"), *S, *HashString);
-
-	return HashString.ToLower() == "eb397865ca4d6f2d48fb44a45424cff0fe60541e";
-}
-
 FReply SExportPak::OnExportPakButtonClicked()
 {
-	TMap<FString, FDependenciesInfo> DependenciesInfos;
-	GetAssetDependecies(DependenciesInfos);
-
-	SaveDependenciesInfo(DependenciesInfos);
-
-	GeneratePakFiles(DependenciesInfos);
-
-	return FReply::Handled();
-}
-
-void SExportPak::CreateTargetAssetListView()
-{
-	// Create a property view
-	FPropertyEditorModule& EditModule = FModuleManager::Get().GetModuleChecked<FPropertyEditorModule>("PropertyEditor");
-
-	FDetailsViewArgs DetailsViewArgs;
-	DetailsViewArgs.bUpdatesFromSelection = true;
-	DetailsViewArgs.bLockable = true;
-	DetailsViewArgs.NameAreaSettings = FDetailsViewArgs::ComponentsAndActorsUseNameArea;
-	DetailsViewArgs.bCustomNameAreaLocation = false;
-	DetailsViewArgs.bCustomFilterAreaLocation = true;
-	DetailsViewArgs.DefaultsOnlyVisibility = EEditDefaultsOnlyNodeVisibility::Hide;
-
-	SettingsView = EditModule.CreateDetailView(DetailsViewArgs);;
-}
-
-void SExportPak::GetAssetDependecies(TMap<FString, FDependenciesInfo>& DependenciesInfos)
-{
-	for (auto &PackageFilePath : ExportPakSettings->PackagesToExport)
+	// The export works on a copy, so the settings stay editable while it runs.
+	// NewObject takes its values from the class default object, which is what the settings view edits.
+	RunningExportSettings = NewObject<UExportPakSettings>(GetTransientPackage());
+	RunningExportSettings->AddToRoot();
+	RunningExporter = MakeShareable(new FExportPakExporter(RunningExportSettings));
+
+	// The asset registry and the target platform manager may only be used on the game thread.
+	if (!RunningExporter->ResolveTargetPlatforms())
 	{
-		FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
-
-		FStringAssetReference AssetRef = PackageFilePath.FilePath;
-		FString TargetLongPackageName = AssetRef.GetLongPackageName();
-
-		if (FPackageName::DoesPackageExist(TargetLongPackageName))
-		{
-			auto &DependenciesInfoEntry = DependenciesInfos.Add(TargetLongPackageName);
-
-			// Try get asset type.
-			{
-				TArray<FAssetData> AssetDataList;
-				bool  bResult = AssetRegistryModule.Get().GetAssetsByPackageName(FName(*TargetLongPackageName), AssetDataList);
-				if (!bResult || AssetDataList.Num() == 0)
-				{
-					UE_LOG(LogExportPak, Error, TEXT("Failed to get AssetData of  %s, please check."), *TargetLongPackageName);
-					return;
-				}
-
-				if (AssetDataList.Num() > 1)
-				{
-					UE_LOG(LogExportPak, Error, TEXT("Got multiple AssetData of  %s, please check."), *TargetLongPackageName);
-				}
-
-				DependenciesInfoEntry.AssetClassString = AssetDataList[0].AssetClass.ToString();
-			}
-
-			GatherDependenciesInfoRecursively(AssetRegistryModule, TargetLongPackageName, DependenciesInfoEntry.DependenciesInGameContentDir, DependenciesInfoEntry.OtherDependencies);
-		}
-
-		TArray<FName>  ACs;
-		AssetRegistryModule.Get().GetAncestorClassNames(*TargetLongPackageName, ACs);
+		FinishExport();
+		NotifyPakFilesGenerated(false, false);
+		return FReply::Handled();
 	}
-}
 
-class FCookedAssetFileVisitor : public IPlatformFile::FDirectoryVisitor
-{
-public:
-	FCookedAssetFileVisitor(const FString& InAssetFilename)
-		:
-		AssetFilename(InAssetFilename)
+	// Paks of a root are written as soon as it is walked, while the next roots are walked on the game thread.
+	TSharedPtr<FExportPakExporter> Exporter = RunningExporter;
+	RunningExport = Async<bool>(EAsyncExecution::Thread, [Exporter]()
 	{
-	}
+		return Exporter->GeneratePakFilesOfQueuedRoots();
+	});
 
-	virtual bool Visit(const TCHAR *FilenameOrDirectory, bool bIsDirectory) override
-	{
-		if (bIsDirectory)
-		{
-			return true;
-		}
+	RunningExporter->BeginDependencyWalk();
+	bWalkingRoots = true;
+	WalkRoots();
 
-		FString StandardizedFilename(FilenameOrDirectory);
-		FPaths::MakeStandardFilename(StandardizedFilename);
-		if (FPaths::GetBaseFilename(StandardizedFilename) == AssetFilename)
-		{
-			Files.Add(StandardizedFilename);
-		}
+	ExportTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &SExportPak::TickExport));
 
-		return true;
-	}
-
-	TArray<FString> Files;
-
-private:
-	FString AssetFilename;
-};
+	return FReply::Handled();
+}
 
-void GenerateIndividualPakFiles(const TArray<FString>& PackagesToHandle, const FString& MainPackage)
+void SExportPak::WalkRoots()
 {
-	FString HashedMainPackageName = HashStringWithSHA1(MainPackage);
-	FString PakOutputDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Paks"), HashedMainPackageName);
-
-	float AmountOfWorkProgress = static_cast<float>(PackagesToHandle.Num());
-	float CurrentProgress = 0.0f;
-	FScopedSlowTask SlowTask(AmountOfWorkProgress);
-	SlowTask.MakeDialog();
-	for (auto& PackageNameInGameDir : PackagesToHandle)
+	// Short slices keep the editor responsive during a long walk.
+	const double EndTime = FPlatformTime::Seconds() + 0.02;
+
+	while (!RunningExporter->GetStatus().bCancelRequested)
 	{
-		// Standardize package name. May this is not necessary.
-		FString TargetLongPackageName;
+		if (!bHasPendingRoot)
 		{
-			FString FailedReason;
-			bool bConvertionResult = FPackageName::TryConvertFilenameToLongPackageName(
-				PackageNameInGameDir,
-				TargetLongPackageName,
-				&FailedReason
-			);
-
-			if (!bConvertionResult)
+			if (FPlatformTime::Seconds() > EndTime)
 			{
-				UE_LOG(LogExportPak, Error, TEXT("        TryConvertFilenameToLongPackageName Failed: %s!"), *FailedReason);
 				return;
 			}
-			else
-			{
-				UE_LOG(LogExportPak, Log, TEXT("        %s"), *TargetLongPackageName);
-			}
-		}
 
-		SlowTask.EnterProgressFrame(CurrentProgress, FText::Format(NSLOCTEXT("ExportPak", "GenerateIndividualPakFiles", "Dependent asset {0}"), FText::FromString(TargetLongPackageName)));
-
-		FString TargetAssetFilepath;
-		{
-			bool bConvertionResult = FPackageName::TryConvertLongPackageNameToFilename(
-				TargetLongPackageName,
-				TargetAssetFilepath,
-				".uasset"
-			);
-			if (!bConvertionResult)
-			{
-				UE_LOG(LogExportPak, Error, TEXT("        TryConvertLongPackageNameToFilename Failed!"));
-				return;
-			}
-			else
+			if (!RunningExporter->WalkNextRoot(PendingRoot))
 			{
-				UE_LOG(LogExportPak, Log, TEXT("            %s"), *TargetAssetFilepath);
+				break;
 			}
+			WalkedDependenciesInfos.Add(PendingRoot.RootPackage, PendingRoot.DependenciesInfo);
+			bHasPendingRoot = true;
 		}
 
-		FString Filename = FPaths::GetBaseFilename(TargetAssetFilepath);
-		FString ProjectName = FPaths::GetBaseFilename(FPaths::GetProjectFilePath());
-		FString IntermediateDirectory = FPaths::GetPath(TargetAssetFilepath).Replace(*FPaths::ProjectDir(), TEXT(""), ESearchCase::CaseSensitive);
-
-		// TODO ArcEcho: Now it is hard-coded to WindowsNoEditor
-		FString TargetCookedAssetDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Cooked/WindowsNoEditor"), ProjectName, IntermediateDirectory);
-
-		FCookedAssetFileVisitor CookedAssetFileVisitor(Filename);
-		FPlatformFileManager::Get().GetPlatformFile().IterateDirectory(*TargetCookedAssetDirectory, CookedAssetFileVisitor);
-
-		FString ResponseFileContent = "";
-		for (auto &f : CookedAssetFileVisitor.Files)
+		// A full queue means the pak generation is behind, try again next tick instead of blocking the editor.
+		if (!RunningExporter->TryQueueRoot(PendingRoot) && !RunningExport.IsReady())
 		{
-			FString Ext = FPaths::GetExtension(f);
-			FString RelativePathForResponseFile = FPaths::Combine(TEXT("../../.."), ProjectName, IntermediateDirectory, Filename) + FString(".") + Ext;
-
-			ResponseFileContent += FString::Printf(TEXT("\"%s\" \"%s\"\n"), *f, *RelativePathForResponseFile);
+			return;
 		}
+		bHasPendingRoot = false;
+	}
 
-		FString HashedPackageName = HashStringWithSHA1(PackageNameInGameDir);
-		FString LogFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp"), HashedPackageName + ".log");
-		FString OutputPakFilepath = FPaths::Combine(PakOutputDirectory, HashedPackageName + TEXT(".pak"));
-
-		FString ResponseFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp"), HashedPackageName + "_Paklist.txt");
-		FFileHelper::SaveStringToFile(ResponseFileContent, *ResponseFilepath);
-
-		FString UnrealPakExeFilepath = FPaths::Combine(FPaths::EngineDir(), TEXT("Binaries/Win64/UnrealPak.exe"));
-		FPaths::MakeStandardFilename(UnrealPakExeFilepath);
-		UnrealPakExeFilepath = FPaths::ConvertRelativePathToFull(UnrealPakExeFilepath);
-
-		FString CommandLine = FString::Printf(
-			TEXT("%s -create=%s -encryptionini -platform=Windows -installed -UTF8Output -multiprocess -patchpaddingalign=2048 -abslog=%s"),
-			*OutputPakFilepath,
-			*ResponseFilepath,
-			*LogFilepath
-		);
-
-		void* PipeRead = nullptr;
-		void* PipeWrite = nullptr;
-		int32 ReturnCode = -1;
-
-		verify(FPlatformProcess::CreatePipe(PipeRead, PipeWrite));
-		bool bLaunchDetached = false;
-		bool bLaunchHidden = true;
-		bool bLaunchReallyHidden = true;
-		uint32* OutProcessID = nullptr ;
-		int32 PriorityModifier = -1;
-		const TCHAR* OptionalWorkingDirectory = nullptr;
-		FProcHandle ProcessHandle = FPlatformProcess::CreateProc(
-			*UnrealPakExeFilepath, *CommandLine,
-			bLaunchDetached, bLaunchHidden, bLaunchReallyHidden,
-			OutProcessID, PriorityModifier,
-			OptionalWorkingDirectory,
-			PipeWrite
-		);
-
-
-		if (ProcessHandle.IsValid())
-		{
-			FPlatformProcess::WaitForProc(ProcessHandle);
-			FPlatformProcess::GetProcReturnCode(ProcessHandle, &ReturnCode);
-			if (ReturnCode == 0)
-			{
-				TArray<FString> OutResults;
-				const FString StdOut = FPlatformProcess::ReadPipe(PipeRead);
-				StdOut.ParseIntoArray(OutResults, TEXT("\n"), true);
-				UE_LOG(LogExportPak, Log, TEXT("ExportPak success:\n%s"), *StdOut);
-			}
-			else
-			{
-				TArray<FString> OutErrorMessages;
-				const FString StdOut = FPlatformProcess::ReadPipe(PipeRead);
-				StdOut.ParseIntoArray(OutErrorMessages, TEXT("\n"), true);
-				UE_LOG(LogExportPak, Warning, TEXT("ExportPak Falied:\nReturnCode=%d\n%s"), ReturnCode, *StdOut);
-			}
+	RunningExporter->CloseRootQueue();
+	bWalkingRoots = false;
+	bHasPendingRoot = false;
 
-			FPlatformProcess::ClosePipe(PipeRead, PipeWrite);
-			FPlatformProcess::CloseProc(ProcessHandle);
-		}
-		else
-		{
-			UE_LOG(LogExportPak, Error, TEXT(" Failed to launch unrealPak.exe: %s"), *UnrealPakExeFilepath);
-		}
-
-		CurrentProgress += 1.0f;
+	if (!RunningExporter->GetStatus().bCancelRequested && RunningExporter->SaveDependenciesInfo(WalkedDependenciesInfos))
+	{
+		NotifyDependenciesInfoSaved(FExportPakExporter::GetDependenciesManifestFilepath());
 	}
+	WalkedDependenciesInfos.Empty();
 }
 
-void GenerateBatchPakFiles(const TArray<FString>& PackagesToHandle, const FString& MainPackage)
+FReply SExportPak::OnCancelButtonClicked()
 {
-	FString HashedMainPackageName = HashStringWithSHA1(MainPackage);
-	FString PakOutputDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Paks"), HashedMainPackageName);
-
-	FString ResponseFileContent = "";
-
-	for (auto& PackageNameInGameDir : PackagesToHandle)
+	if (RunningExporter.IsValid())
 	{
-		// Standardize package name. May this is not necessary.
-		FString TargetLongPackageName;
-		{
-			FString FailedReason;
-			bool bConvertionResult = FPackageName::TryConvertFilenameToLongPackageName(
-				PackageNameInGameDir,
-				TargetLongPackageName,
-				&FailedReason
-			);
-
-			if (!bConvertionResult)
-			{
-				UE_LOG(LogExportPak, Error, TEXT("        TryConvertFilenameToLongPackageName Failed: %s!"), *FailedReason);
-				return;
-			}
-			else
-			{
-				UE_LOG(LogExportPak, Log, TEXT("        %s"), *TargetLongPackageName);
-			}
-		}
-
-		FString TargetAssetFilepath;
-		{
-			bool bConvertionResult = FPackageName::TryConvertLongPackageNameToFilename(
-				TargetLongPackageName,
-				TargetAssetFilepath,
-				".uasset"
-			);
-			if (!bConvertionResult)
-			{
-				UE_LOG(LogExportPak, Error, TEXT("        TryConvertLongPackageNameToFilename Failed!"));
-				return;
-			}
-			else
-			{
-				UE_LOG(LogExportPak, Log, TEXT("            %s"), *TargetAssetFilepath);
-			}
-		}
-
-		FString Filename = FPaths::GetBaseFilename(TargetAssetFilepath);
-		FString ProjectName = FPaths::GetBaseFilename(FPaths::GetProjectFilePath());
-		FString IntermediateDirectory = FPaths::GetPath(TargetAssetFilepath).Replace(*FPaths::ProjectDir(), TEXT(""), ESearchCase::CaseSensitive);
-
-		// TODO ArcEcho: Now it is hard-coded to WindowsNoEditor
-		FString TargetCookedAssetDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Cooked/WindowsNoEditor"), ProjectName, IntermediateDirectory);
+		RunningExporter->Cancel();
+	}
 
-		FCookedAssetFileVisitor CookedAssetFileVisitor(Filename);
-		FPlatformFileManager::Get().GetPlatformFile().IterateDirectory(*TargetCookedAssetDirectory, CookedAssetFileVisitor);
+	return FReply::Handled();
+}
 
-		for (auto &f : CookedAssetFileVisitor.Files)
-		{
-			FString Ext = FPaths::GetExtension(f);
-			FString RelativePathForResponseFile = FPaths::Combine(TEXT("../../.."), ProjectName, IntermediateDirectory, Filename) + FString(".") + Ext;
+void SExportPak::FinishExport()
+{
+	bWalkingRoots = false;
+	bHasPendingRoot = false;
+	WalkedDependenciesInfos.Empty();
 
-			ResponseFileContent += FString::Printf(TEXT("\"%s\" \"%s\"\n"), *f, *RelativePathForResponseFile);
-		}
-	}
+	RunningExporter.Reset();
+	RunningExport = TFuture<bool>();
 
-	FString HashedPackageName = HashStringWithSHA1(MainPackage);
-	FString LogFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp"), HashedPackageName + ".log");
-	FString OutputPakFilepath = FPaths::Combine(PakOutputDirectory, HashedPackageName + TEXT(".pak"));
-
-	FString ResponseFilepath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Temp"), HashedPackageName + "_Paklist.txt");
-	FFileHelper::SaveStringToFile(ResponseFileContent, *ResponseFilepath);
-
-	FString UnrealPakExeFilepath = FPaths::Combine(FPaths::EngineDir(), TEXT("Binaries/Win64/UnrealPak.exe"));
-	FPaths::MakeStandardFilename(UnrealPakExeFilepath);
-	UnrealPakExeFilepath = FPaths::ConvertRelativePathToFull(UnrealPakExeFilepath);
-
-	FString CommandLine = FString::Printf(
-		TEXT("%s -create=%s -encryptionini -platform=Windows -installed -UTF8Output -multiprocess -patchpaddingalign=2048 -abslog=%s"),
-		*OutputPakFilepath,
-		*ResponseFilepath,
-		*LogFilepath
-	);
-
-	void* PipeRead = nullptr;
-	void* PipeWrite = nullptr;
-	int32 ReturnCode = -1;
-
-	verify(FPlatformProcess::CreatePipe(PipeRead, PipeWrite));
-	bool bLaunchDetached = false;
-	bool bLaunchHidden = true;
-	bool bLaunchReallyHidden = true;
-	uint32* OutProcessID = nullptr;
-	int32 PriorityModifier = -1;
-	const TCHAR* OptionalWorkingDirectory = nullptr;
-	FProcHandle ProcessHandle = FPlatformProcess::CreateProc(
-		*UnrealPakExeFilepath, *CommandLine,
-		bLaunchDetached, bLaunchHidden, bLaunchReallyHidden,
-		OutProcessID, PriorityModifier,
-		OptionalWorkingDirectory,
-		PipeWrite
-	);
-
-	if (ProcessHandle.IsValid())
+	if (RunningExportSettings != nullptr)
 	{
-		FPlatformProcess::WaitForProc(ProcessHandle);
-		FPlatformProcess::GetProcReturnCode(ProcessHandle, &ReturnCode);
-		if (ReturnCode == 0)
-		{
-			TArray<FString> OutResults;
-			const FString StdOut = FPlatformProcess::ReadPipe(PipeRead);
-			StdOut.ParseIntoArray(OutResults, TEXT("\n"), true);
-			UE_LOG(LogExportPak, Log, TEXT("ExportPak success:\n%s"),  *StdOut);
-		}
-		else
-		{
-			TArray<FString> OutErrorMessages;
-			const FString StdOut = FPlatformProcess::ReadPipe(PipeRead);
-			StdOut.ParseIntoArray(OutErrorMessages, TEXT("\n"), true);
-			UE_LOG(LogExportPak, Warning, TEXT("ExportPak Falied:\nReturnCode=%d\n%s"), ReturnCode, *StdOut);
-		}
-
-		FPlatformProcess::CloseProc(ProcessHandle);
-		FPlatformProcess::ClosePipe(PipeRead, PipeWrite);
+		RunningExportSettings->RemoveFromRoot();
+		RunningExportSettings = nullptr;
 	}
-	else
-	{
-		UE_LOG(LogExportPak, Error, TEXT(" Failed to launch unrealPak.exe: %s"), *UnrealPakExeFilepath);
-	}
-
 }
 
-void SExportPak::GeneratePakFiles(const TMap<FString, FDependenciesInfo> &DependenciesInfos)
+TOptional<float> SExportPak::GetExportProgress() const
 {
-	float AmountOfWorkProgress = static_cast<float>(DependenciesInfos.Num());
-	float CurrentProgress = 0.0f;
-	FScopedSlowTask SlowTask(AmountOfWorkProgress);
-	SlowTask.MakeDialog();
-	for (auto &DependencyInfo : DependenciesInfos)
+	if (!RunningExporter.IsValid())
 	{
-		SlowTask.EnterProgressFrame(CurrentProgress, FText::Format(NSLOCTEXT("ExportPak", "GeneratePakFiles", "Exporting Paks of asset: {0}"), FText::FromString(DependencyInfo.Key)));
+		return TOptional<float>();
+	}
 
-		FString HashedLongPackageName = HashStringWithSHA1(DependencyInfo.Key);
-		TArray<FString> PackagesToHandle = DependencyInfo.Value.DependenciesInGameContentDir;
-		PackagesToHandle.Add(DependencyInfo.Key);
-		
-		if(ExportPakSettings->bUseBatchMode)
-		{
-			GenerateBatchPakFiles(PackagesToHandle, DependencyInfo.Key);
-		}
-		else
-		{
-			GenerateIndividualPakFiles(PackagesToHandle, DependencyInfo.Key);
-		}
+	// Paks are queued root by root, so weight each root equally and spread its paks over it.
+	const FExportPakStatus& Status = RunningExporter->GetStatus();
+	const int32 NumRoots = FMath::Max(1, Status.NumRoots.GetValue());
+	const int32 NumPaks = Status.NumPaks.GetValue();
+	const float PakFraction = NumPaks > 0 ? static_cast<float>(Status.NumPaksFinished.GetValue()) / NumPaks : 0.0f;
 
-		SavePakDescriptionFile(DependencyInfo.Key, DependencyInfo.Value);
-		CurrentProgress += 1.0f;
-	}
+	return FMath::Clamp((Status.NumRootsFinished.GetValue() + PakFraction) / NumRoots, 0.0f, 1.0f);
 }
 
-void SExportPak::SavePakDescriptionFile(const FString& TargetPackage, const FDependenciesInfo& DependecyInfo)
+FText SExportPak::GetExportStatusText() const
 {
-	FString HashedMainPackageName = HashStringWithSHA1(TargetPackage);
-	FString PakOutputDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Paks"), HashedMainPackageName);
-
-	TSharedPtr<FJsonObject> RootJsonObject = MakeShareable(new FJsonObject);
+	if (!RunningExporter.IsValid())
 	{
-		RootJsonObject->SetStringField("long_package_name", TargetPackage);
-
-		FString PakFilepath = FPaths::Combine(PakOutputDirectory, HashedMainPackageName + TEXT(".pak"));
-
-		RootJsonObject->SetStringField("pak_file", HashedMainPackageName + TEXT(".pak"));
-		RootJsonObject->SetStringField("asset_class", DependecyInfo.AssetClassString);
-
-		FString FileSizeInBytes = FString::Printf(TEXT("%lld"), FPlatformFileManager::Get().GetPlatformFile().FileSize(*PakFilepath));
-		RootJsonObject->SetStringField("file_size_in_bytes", FileSizeInBytes);
+		return FText::GetEmpty();
 	}
 
-	TArray<TSharedPtr<FJsonValue>> DependencyEntries;
-	for (const auto& DependencyInGameContentDir : DependecyInfo.DependenciesInGameContentDir)
+	const FExportPakStatus& Status = RunningExporter->GetStatus();
+	if (Status.bCancelRequested)
 	{
-		TSharedPtr<FJsonObject> EntryJsonObject = MakeShareable(new FJsonObject);
-
-		FString HashedPackageName = HashStringWithSHA1(DependencyInGameContentDir);
-		FString PakFilepath = FPaths::Combine(PakOutputDirectory, HashedPackageName + TEXT(".pak"));
-		FString FileSizeInBytes = FString::Printf(TEXT("%lld"), FPlatformFileManager::Get().GetPlatformFile().FileSize(*PakFilepath));
+		return LOCTEXT("ExportPakCancelling", "Cancelling...");
+	}
 
-		EntryJsonObject->SetStringField("long_package_name", DependencyInGameContentDir);
-		EntryJsonObject->SetStringField("pak_file", HashedPackageName + TEXT(".pak"));
-		EntryJsonObject->SetStringField("file_size_in_bytes", FileSizeInBytes);
+	return FText::Format(LOCTEXT("ExportPakStatus", "{0} / {1} asset(s), {2} / {3} pak file(s)"),
+		FText::AsNumber(Status.NumRootsFinished.GetValue()),
+		FText::AsNumber(Status.NumRoots.GetValue()),
+		FText::AsNumber(Status.NumPaksFinished.GetValue()),
+		FText::AsNumber(Status.NumPaks.GetValue()));
+}
 
-		TSharedRef< FJsonValueObject > JsonValue = MakeShareable(new FJsonValueObject(EntryJsonObject));
-		DependencyEntries.Add(JsonValue);
-	}
-	RootJsonObject->SetArrayField("dependencies_in_game_content_dir", DependencyEntries);
+EVisibility SExportPak::GetExportProgressVisibility() const
+{
+	return RunningExporter.IsValid() ? EVisibility::Visible : EVisibility::Collapsed;
+}
 
-	FString OutputString;
-	auto JsonWirter = TJsonWriterFactory<>::Create(&OutputString);
-	FJsonSerializer::Serialize(RootJsonObject.ToSharedRef(), JsonWirter);
+void SExportPak::CreateTargetAssetListView()
+{
+	// Create a property view
+	FPropertyEditorModule& EditModule = FModuleManager::Get().GetModuleChecked<FPropertyEditorModule>("PropertyEditor");
 
-	FString PakDescriptionFilename = FPaths::Combine(PakOutputDirectory,  HashedMainPackageName + TEXT(".json"));
-	PakDescriptionFilename = FPaths::ConvertRelativePathToFull(PakDescriptionFilename);
+	FDetailsViewArgs DetailsViewArgs;
+	DetailsViewArgs.bUpdatesFromSelection = true;
+	DetailsViewArgs.bLockable = true;
+	DetailsViewArgs.NameAreaSettings = FDetailsViewArgs::ComponentsAndActorsUseNameArea;
+	DetailsViewArgs.bCustomNameAreaLocation = false;
+	DetailsViewArgs.bCustomFilterAreaLocation = true;
+	DetailsViewArgs.DefaultsOnlyVisibility = EEditDefaultsOnlyNodeVisibility::Hide;
 
-	// Attention to FFileHelper::EEncodingOptions::ForceUTF8 here. 
-	// In some case, UE4 will save as UTF16 according to the content.
-	bool bSaveSuccess = FFileHelper::SaveStringToFile(OutputString, *PakDescriptionFilename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
-	if (!bSaveSuccess)
-	{
-		UE_LOG(LogExportPak, Error, TEXT("Failed to save pak description file: %s"), *PakDescriptionFilename);
-	}
+	SettingsView = EditModule.CreateDetailView(DetailsViewArgs);;
 }
 
-void SExportPak::GatherDependenciesInfoRecursively(FAssetRegistryModule &AssetRegistryModule, const FString &TargetLongPackageName, TArray<FString> &DependenciesInGameContentDir, TArray<FString> &OtherDependencies)
+void SExportPak::NotifyDependenciesInfoSaved(const FString& ResultFileFilename)
 {
-	TArray<FName> Dependencies;
-	bool bGetDependenciesSuccess = AssetRegistryModule.Get().GetDependencies(FName(*TargetLongPackageName), Dependencies, EAssetRegistryDependencyType::Packages);
-	if (bGetDependenciesSuccess)
+	// UE4 API to show an editor notification.
+	auto Message = LOCTEXT("ExportPakSuccessNotification", "Succeed to export asset dependecies.");
+	FNotificationInfo Info(Message);
+	Info.bFireAndForget = true;
+	Info.ExpireDuration = 5.0f;
+	Info.bUseSuccessFailIcons = false;
+	Info.bUseLargeFont = false;
+
+	const FString HyperLinkText = ResultFileFilename;
+	Info.Hyperlink = FSimpleDelegate::CreateStatic([](FString SourceFilePath)
 	{
-		for (auto &d : Dependencies)
-		{
-			// Pick out packages in game content dir.
-			FString LongDependentPackageName = d.ToString();
-			if (LongDependentPackageName.StartsWith("/Game"))
-			{
-				// Try find firstly to avoid duplicated entry.
-				if (DependenciesInGameContentDir.Find(LongDependentPackageName) == INDEX_NONE)
-				{
-					DependenciesInGameContentDir.Add(LongDependentPackageName);
-					GatherDependenciesInfoRecursively(AssetRegistryModule, LongDependentPackageName, DependenciesInGameContentDir, OtherDependencies);
-				}
-			}
-			else
-			{
-				if (OtherDependencies.Find(LongDependentPackageName) == INDEX_NONE)
-				{
-					OtherDependencies.Add(LongDependentPackageName);
-					GatherDependenciesInfoRecursively(AssetRegistryModule, LongDependentPackageName, DependenciesInGameContentDir, OtherDependencies);
-				}
-			}
-		}
-	}
+		FPlatformProcess::ExploreFolder(*SourceFilePath);
+	}, HyperLinkText);
+	Info.HyperlinkText = FText::FromString(HyperLinkText);
+
+	FSlateNotificationManager::Get().AddNotification(Info)->SetCompletionState(SNotificationItem::CS_Success);
 }
 
-void SExportPak::SaveDependenciesInfo(const TMap<FString, FDependenciesInfo> &DependenciesInfos)
+void SExportPak::NotifyPakFilesGenerated(bool bSuccess, bool bCancelled)
 {
-	TSharedPtr<FJsonObject> RootJsonObject = MakeShareable(new FJsonObject);
-	for (auto &DependenciesInfoEntry : DependenciesInfos)
+	FText Message = LOCTEXT("ExportPakFilesSuccessNotification", "Succeed to export pak files.");
+	if (bCancelled)
 	{
-		TSharedPtr<FJsonObject> EntryJsonObject = MakeShareable(new FJsonObject);
-
-		// Write current AssetClass.
-		EntryJsonObject->SetStringField("AssetClass", DependenciesInfoEntry.Value.AssetClassString);
-
-		// Write dependencies in game content dir.
-		{
-			TArray< TSharedPtr<FJsonValue> > DependenciesEntry;
-			for (auto &d : DependenciesInfoEntry.Value.DependenciesInGameContentDir)
-			{
-				DependenciesEntry.Add(MakeShareable(new FJsonValueString(d)));
-			}
-			EntryJsonObject->SetArrayField("DependenciesInGameContentDir", DependenciesEntry);
-		}
-
-		// Write dependencies not in game content dir.
-		{
-			TArray< TSharedPtr<FJsonValue> > DependenciesEntry;
-			for (auto &d : DependenciesInfoEntry.Value.OtherDependencies)
-			{
-				DependenciesEntry.Add(MakeShareable(new FJsonValueString(d)));
-			}
-			EntryJsonObject->SetArrayField("OtherDependencies", DependenciesEntry);
-		}
-
-		RootJsonObject->SetObjectField(DependenciesInfoEntry.Key, EntryJsonObject);
+		Message = LOCTEXT("ExportPakFilesCancelledNotification", "Pak export cancelled.");
+	}
+	else if (!bSuccess)
+	{
+		Message = LOCTEXT("ExportPakFilesFailedNotification", "Failed to export some pak files, see the output log.");
 	}
 
-	FString OutputString;
-	auto JsonWirter = TJsonWriterFactory<>::Create(&OutputString);
-	FJsonSerializer::Serialize(RootJsonObject.ToSharedRef(), JsonWirter);
-
-	FString ResultFileFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak"), TEXT("/AssetDependencies.json"));
-	ResultFileFilename = FPaths::ConvertRelativePathToFull(ResultFileFilename);
+	FNotificationInfo Info(Message);
+	Info.bFireAndForget = true;
+	Info.ExpireDuration = 5.0f;
+	Info.bUseSuccessFailIcons = true;
+	Info.bUseLargeFont = false;
 
-	// Attention to FFileHelper::EEncodingOptions::ForceUTF8 here. 
-	// In some case, UE4 will save as UTF16 according to the content.
-	bool bSaveSuccess = FFileHelper::SaveStringToFile(OutputString, *ResultFileFilename, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
-	if (bSaveSuccess)
+	const FString HyperLinkText = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ExportPak/Paks")));
+	Info.Hyperlink = FSimpleDelegate::CreateStatic([](FString SourceFilePath)
 	{
-		// UE4 API to show an editor notification.
-		auto Message = LOCTEXT("ExportPakSuccessNotification", "Succeed to export asset dependecies.");
-		FNotificationInfo Info(Message);
-		Info.bFireAndForget = true;
-		Info.ExpireDuration = 5.0f;
-		Info.bUseSuccessFailIcons = false;
-		Info.bUseLargeFont = false;
-
-		const FString HyperLinkText = ResultFileFilename;
-		Info.Hyperlink = FSimpleDelegate::CreateStatic([](FString SourceFilePath)
-		{
-			FPlatformProcess::ExploreFolder(*SourceFilePath);
-		}, HyperLinkText);
-		Info.HyperlinkText = FText::FromString(HyperLinkText);
+		FPlatformProcess::ExploreFolder(*SourceFilePath);
+	}, HyperLinkText);
+	Info.HyperlinkText = FText::FromString(HyperLinkText);
 
-		FSlateNotificationManager::Get().AddNotification(Info)->SetCompletionState(SNotificationItem::CS_Success);
-	}
-	else
-	{
-		UE_LOG(LogExportPak, Error, TEXT("Failed to export %s"), *ResultFileFilename);
-	}
+	FSlateNotificationManager::Get().AddNotification(Info)->SetCompletionState(bSuccess ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
 }
 
-#undef LOCTEXT_NAMESPACE
\ No newline at end of file
+#undef LOCTEXT_NAMESPACE
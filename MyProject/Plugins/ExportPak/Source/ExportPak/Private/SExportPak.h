@@ -7,13 +7,13 @@
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "Input/Reply.h"
 #include "Widgets/SCompoundWidget.h"
+#include "Async/Future.h"
+#include "ExportPakExporter.h"
 
 
 class IDetailsView;
 class SBox;
 class UExportPakSettings;
-struct FDependenciesInfo; 
-class FAssetRegistryModule;
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -35,22 +35,38 @@ public:
 	*/
 	void Construct(const FArguments& InArgs);
 
+	virtual ~SExportPak();
+
 private:
+	/**
+	 * Walks roots and picks up the result of a finished background export.
+	 * Ticked by the core ticker, Slate does not tick the widget while its tab is hidden.
+	 */
+	bool TickExport(float DeltaTime);
+
+	/** Starts the pak generation on a background thread and the dependency walk that feeds it. */
 	FReply OnExportPakButtonClicked();
 
-	void CreateTargetAssetListView();
+	/** Walks roots for a few milliseconds per tick and queues them, the asset registry is game thread only. */
+	void WalkRoots();
 
-	void GetAssetDependecies(TMap<FString, FDependenciesInfo>& DependenciesInfos);
+	FReply OnCancelButtonClicked();
 
-	void GeneratePakFiles(const TMap<FString, FDependenciesInfo> &DependenciesInfos);
+	/** Drop the exporter and the settings copy of the last export. */
+	void FinishExport();
 
-	void SavePakDescriptionFile(const FString& TargetPackage, const FDependenciesInfo& DependecyInfo);
+	TOptional<float> GetExportProgress() const;
+
+	FText GetExportStatusText() const;
+
+	EVisibility GetExportProgressVisibility() const;
+
+	void CreateTargetAssetListView();
 
-	void GatherDependenciesInfoRecursively(FAssetRegistryModule &AssetRegistryModule, const FString &TargetLongPackageName,
-		TArray<FString> &DependenciesInGameContentDir, TArray<FString> &OtherDependencies);
+	/** Editor notification with a link to the saved dependencies file. */
+	void NotifyDependenciesInfoSaved(const FString& ResultFileFilename);
 
-	/** This will save the dependencies information to the OutputPath/AssetDependencies.json */
-	void SaveDependenciesInfo(const TMap<FString, FDependenciesInfo> &DependenciesInfos);
+	void NotifyPakFilesGenerated(bool bSuccess, bool bCancelled);
 
 	bool CanExportPakExecuted() const;
 
@@ -64,4 +80,24 @@ private:
 
 	UExportPakSettings* ExportPakSettings;
 
+	/** Set while pak files are being generated in the background. */
+	TSharedPtr<FExportPakExporter> RunningExporter;
+
+	TFuture<bool> RunningExport;
+
+	/** TickExport() in the core ticker, set while an export runs. */
+	FDelegateHandle ExportTickerHandle;
+
+	/** Set until every root of the running export has been walked and queued. */
+	bool bWalkingRoots = false;
+
+	/** Walked root the queue had no room for yet. */
+	bool bHasPendingRoot = false;
+	FExportPakWalkedRoot PendingRoot;
+
+	TMap<FString, FDependenciesInfo> WalkedDependenciesInfos;
+
+	/** Rooted copy of ExportPakSettings the running export reads. */
+	UExportPakSettings* RunningExportSettings = nullptr;
+
 };
\ No newline at end of file
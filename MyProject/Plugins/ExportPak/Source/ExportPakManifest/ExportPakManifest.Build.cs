@@ -0,0 +1,31 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class ExportPakManifest : ModuleRules
+{
+	public ExportPakManifest(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicIncludePaths.AddRange(
+			new string[] {
+				"ExportPakManifest/Public"
+			}
+			);
+
+		PrivateIncludePaths.AddRange(
+			new string[] {
+				"ExportPakManifest/Private",
+			}
+			);
+
+		// Shipped with the game by the patch client, so nothing but Core.
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+			}
+			);
+	}
+}
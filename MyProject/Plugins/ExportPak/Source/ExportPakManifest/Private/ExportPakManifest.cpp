@@ -0,0 +1,216 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "ExportPakManifest.h"
+
+namespace ExportPakManifest
+{
+	bool IsSectionValid(uint64 Offset, uint64 ElementSize, uint64 NumElements, int64 DataSize)
+	{
+		return Offset % 4 == 0 && Offset <= (uint64)DataSize && NumElements <= ((uint64)DataSize - Offset) / ElementSize;
+	}
+}
+
+FExportPakManifest::FExportPakManifest()
+	:
+	Header(nullptr),
+	Packages(nullptr),
+	Roots(nullptr),
+	Edges(nullptr),
+	StringData(nullptr)
+{
+}
+
+bool FExportPakManifest::Initialize(const void* InData, int64 InSize)
+{
+	Header = nullptr;
+
+	const uint8* Data = static_cast<const uint8*>(InData);
+	if (Data == nullptr || InSize < (int64)sizeof(FExportPakManifestHeader) || !IsAligned(Data, 4))
+	{
+		return false;
+	}
+
+	const FExportPakManifestHeader* NewHeader = reinterpret_cast<const FExportPakManifestHeader*>(Data);
+	if (NewHeader->Magic != ExportPakManifest::Magic || NewHeader->Version != ExportPakManifest::Version || NewHeader->NameHash > (uint32)EExportPakNameHash::LegacyAnsi)
+	{
+		return false;
+	}
+
+	// Only the sections are checked, so opening a manifest stays O(1) whatever its size.
+	if (!ExportPakManifest::IsSectionValid(NewHeader->PackagesOffset, sizeof(FExportPakManifestPackage), NewHeader->NumPackages, InSize)
+		|| !ExportPakManifest::IsSectionValid(NewHeader->RootsOffset, sizeof(FExportPakManifestRoot), NewHeader->NumRoots, InSize)
+		|| !ExportPakManifest::IsSectionValid(NewHeader->EdgesOffset, sizeof(uint32), NewHeader->NumEdges, InSize)
+		|| !ExportPakManifest::IsSectionValid(NewHeader->StringDataOffset, 1, NewHeader->StringDataSize, InSize)
+		|| NewHeader->StringDataSize == 0 || Data[NewHeader->StringDataOffset + NewHeader->StringDataSize - 1] != 0)
+	{
+		return false;
+	}
+
+	Header = NewHeader;
+	Packages = reinterpret_cast<const FExportPakManifestPackage*>(Data + Header->PackagesOffset);
+	Roots = reinterpret_cast<const FExportPakManifestRoot*>(Data + Header->RootsOffset);
+	Edges = reinterpret_cast<const uint32*>(Data + Header->EdgesOffset);
+	StringData = reinterpret_cast<const ANSICHAR*>(Data + Header->StringDataOffset);
+
+	return true;
+}
+
+int32 FExportPakManifest::GetNumPackages() const
+{
+	return Header ? (int32)Header->NumPackages : 0;
+}
+
+int32 FExportPakManifest::GetNumRoots() const
+{
+	return Header ? (int32)Header->NumRoots : 0;
+}
+
+EExportPakNameHash FExportPakManifest::GetNameHash() const
+{
+	return Header ? (EExportPakNameHash)Header->NameHash : EExportPakNameHash::Utf8;
+}
+
+FSHAHash FExportPakManifest::HashPackageName(const FString& LongPackageName, EExportPakNameHash NameHash)
+{
+	FSHAHash Hash;
+	if (NameHash == EExportPakNameHash::LegacyAnsi)
+	{
+		// One byte per TCHAR, so Len() is the byte count.
+		FSHA1::HashBuffer(TCHAR_TO_ANSI(*LongPackageName), LongPackageName.Len(), Hash.Hash);
+	}
+	else
+	{
+		FTCHARToUTF8 Utf8Name(*LongPackageName);
+		FSHA1::HashBuffer(Utf8Name.Get(), Utf8Name.Length(), Hash.Hash);
+	}
+	return Hash;
+}
+
+int32 FExportPakManifest::FindPackage(const FString& LongPackageName) const
+{
+	return FindPackageByHash(HashPackageName(LongPackageName, GetNameHash()));
+}
+
+int32 FExportPakManifest::FindPackageByHash(const FSHAHash& Hash) const
+{
+	int32 Low = 0;
+	int32 High = GetNumPackages();
+	while (Low < High)
+	{
+		const int32 Middle = Low + (High - Low) / 2;
+		const int32 Comparison = FMemory::Memcmp(Packages[Middle].Hash, Hash.Hash, sizeof(Hash.Hash));
+		if (Comparison == 0)
+		{
+			return Middle;
+		}
+		else if (Comparison < 0)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+const FExportPakManifestPackage& FExportPakManifest::GetPackage(int32 PackageIndex) const
+{
+	check(PackageIndex >= 0 && PackageIndex < GetNumPackages());
+	return Packages[PackageIndex];
+}
+
+FString FExportPakManifest::GetString(uint32 Offset) const
+{
+	if (Offset >= Header->StringDataSize)
+	{
+		return FString();
+	}
+
+	return FString(UTF8_TO_TCHAR(StringData + Offset));
+}
+
+FString FExportPakManifest::GetPackageName(int32 PackageIndex) const
+{
+	return GetString(GetPackage(PackageIndex).Name);
+}
+
+FSHAHash FExportPakManifest::GetPackageHash(int32 PackageIndex) const
+{
+	FSHAHash Hash;
+	FMemory::Memcpy(Hash.Hash, GetPackage(PackageIndex).Hash, sizeof(Hash.Hash));
+	return Hash;
+}
+
+FString FExportPakManifest::GetAssetClass(int32 PackageIndex) const
+{
+	return GetString(GetPackage(PackageIndex).AssetClass);
+}
+
+bool FExportPakManifest::IsRoot(int32 PackageIndex) const
+{
+	return GetRoot(PackageIndex) != nullptr;
+}
+
+int32 FExportPakManifest::GetRootPackage(int32 RootIndex) const
+{
+	check(RootIndex >= 0 && RootIndex < GetNumRoots());
+	return (int32)Roots[RootIndex].Package;
+}
+
+const FExportPakManifestRoot* FExportPakManifest::GetRoot(int32 PackageIndex) const
+{
+	const int32 RootIndex = GetPackage(PackageIndex).RootIndex;
+	if (RootIndex < 0 || RootIndex >= GetNumRoots())
+	{
+		return nullptr;
+	}
+
+	// A corrupt root must not make the edge slice point outside the data.
+	const FExportPakManifestRoot* Root = &Roots[RootIndex];
+	const uint64 EdgeEnd = (uint64)Root->FirstEdge + Root->NumDependenciesInGameContentDir + Root->NumOtherDependencies;
+	return EdgeEnd <= Header->NumEdges ? Root : nullptr;
+}
+
+TArrayView<const uint32> FExportPakManifest::GetDependencies(int32 PackageIndex) const
+{
+	const FExportPakManifestRoot* Root = GetRoot(PackageIndex);
+	if (Root == nullptr)
+	{
+		return TArrayView<const uint32>();
+	}
+
+	return TArrayView<const uint32>(Edges + Root->FirstEdge, Root->NumDependenciesInGameContentDir + Root->NumOtherDependencies);
+}
+
+int32 FExportPakManifest::GetNumDependenciesInGameContentDir(int32 PackageIndex) const
+{
+	const FExportPakManifestRoot* Root = GetRoot(PackageIndex);
+	return Root ? (int32)Root->NumDependenciesInGameContentDir : 0;
+}
+
+bool FExportPakManifest::GetDependencyPaks(const FString& RootPackage, TArray<FString>& OutPakFiles) const
+{
+	const int32 PackageIndex = FindPackage(RootPackage);
+	if (PackageIndex == INDEX_NONE || !IsRoot(PackageIndex))
+	{
+		return false;
+	}
+
+	OutPakFiles.Add(GetPackageHash(PackageIndex).ToString() + TEXT(".pak"));
+
+	TArrayView<const uint32> Dependencies = GetDependencies(PackageIndex);
+	const int32 NumDependenciesInGameContentDir = GetNumDependenciesInGameContentDir(PackageIndex);
+	for (int32 DependencyIndex = 0; DependencyIndex < NumDependenciesInGameContentDir; ++DependencyIndex)
+	{
+		const int32 DependencyPackage = (int32)Dependencies[DependencyIndex];
+		if (DependencyPackage < GetNumPackages())
+		{
+			OutPakFiles.Add(GetPackageHash(DependencyPackage).ToString() + TEXT(".pak"));
+		}
+	}
+
+	return true;
+}
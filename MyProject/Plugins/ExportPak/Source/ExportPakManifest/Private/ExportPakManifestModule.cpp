@@ -0,0 +1,6 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "ModuleManager.h"
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, ExportPakManifest)
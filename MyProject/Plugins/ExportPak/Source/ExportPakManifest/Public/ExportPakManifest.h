@@ -0,0 +1,147 @@
+// Copyright 1998-2017 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ArrayView.h"
+#include "Misc/SecureHash.h"
+
+/** How a long package name is turned into the bytes the SHA1 pak files are named with is taken of. */
+enum class EExportPakNameHash : uint32
+{
+	/** The UTF-8 encoding of the name. */
+	Utf8,
+
+	/** TCHAR_TO_ANSI of the name, what exports named their paks with before. Same as Utf8 for ASCII names, every other character becomes '?'. */
+	LegacyAnsi,
+};
+
+/**
+ * Layout of AssetDependencies.bin, the binary form of AssetDependencies.json.
+ * Little-endian, every offset is in bytes from the start of the file and every section is 8 byte aligned,
+ * so the file can be used in place from a memory-mapped view.
+ *
+ * [Header][Packages sorted by Hash][Roots][Edges][String data]
+ */
+struct FExportPakManifestHeader
+{
+	/** ExportPakManifest::Magic */
+	uint32 Magic;
+
+	/** ExportPakManifest::Version */
+	uint32 Version;
+
+	uint32 NumPackages;
+	uint32 NumRoots;
+	uint32 NumEdges;
+
+	/** UTF-8, NUL-terminated strings back to back. Starts with an empty string, so offset 0 means none. */
+	uint32 StringDataSize;
+
+	/** EExportPakNameHash of the package hashes. */
+	uint32 NameHash;
+
+	uint32 Reserved;
+
+	uint64 PackagesOffset;
+	uint64 RootsOffset;
+	uint64 EdgesOffset;
+	uint64 StringDataOffset;
+};
+
+/** Every package a root or a dependency refers to, once. */
+struct FExportPakManifestPackage
+{
+	/** SHA1 of the long package name, the name of its pak file. Packages are sorted by it. */
+	uint8 Hash[20];
+
+	/** Offset of the long package name in the string data. */
+	uint32 Name;
+
+	/** Offset of the asset class in the string data, only set for roots. */
+	uint32 AssetClass;
+
+	/** Index in the roots section, INDEX_NONE if the package is not a root. */
+	int32 RootIndex;
+};
+
+/** The dependencies of root R are Edges[R.FirstEdge, R.FirstEdge + R.NumDependenciesInGameContentDir + R.NumOtherDependencies), the ones in the game content dir first. */
+struct FExportPakManifestRoot
+{
+	uint32 Package;
+	uint32 FirstEdge;
+	uint32 NumDependenciesInGameContentDir;
+	uint32 NumOtherDependencies;
+};
+
+namespace ExportPakManifest
+{
+	static const uint32 Magic = 0x4D4B5045; // "EPKM"
+	static const uint32 Version = 2;
+}
+
+/**
+ * Reads AssetDependencies.bin without parsing or copying it: a package is found by binary search on its hash
+ * and its dependencies are a slice of the edge section.
+ * It only keeps a pointer to the data, which must outlive it, e.g. a memory-mapped view or a loaded buffer.
+ */
+class EXPORTPAKMANIFEST_API FExportPakManifest
+{
+public:
+	FExportPakManifest();
+
+	/** Checks the header and that every section is inside the data. Returns false if it is not a manifest of this version. */
+	bool Initialize(const void* InData, int64 InSize);
+
+	int32 GetNumPackages() const;
+
+	int32 GetNumRoots() const;
+
+	/** How the exporter that wrote the manifest named its paks. */
+	EExportPakNameHash GetNameHash() const;
+
+	/** Index of the package, INDEX_NONE if the manifest does not know it. O(log n). */
+	int32 FindPackage(const FString& LongPackageName) const;
+
+	int32 FindPackageByHash(const FSHAHash& Hash) const;
+
+	FString GetPackageName(int32 PackageIndex) const;
+
+	FSHAHash GetPackageHash(int32 PackageIndex) const;
+
+	/** Empty for packages that are not roots. */
+	FString GetAssetClass(int32 PackageIndex) const;
+
+	bool IsRoot(int32 PackageIndex) const;
+
+	/** Package index of the Nth root, in the order they were exported. */
+	int32 GetRootPackage(int32 RootIndex) const;
+
+	/** Package indices of everything the root depends on, the ones in the game content dir first. Empty if it is not a root. */
+	TArrayView<const uint32> GetDependencies(int32 PackageIndex) const;
+
+	int32 GetNumDependenciesInGameContentDir(int32 PackageIndex) const;
+
+	/**
+	 * Pak files to mount for a root: its own and the one of every dependency in the game content dir, as <SHA1>.pak.
+	 * Returns false if RootPackage is not a root of the manifest.
+	 */
+	bool GetDependencyPaks(const FString& RootPackage, TArray<FString>& OutPakFiles) const;
+
+	/** SHA1 the exporter names pak files with. */
+	static FSHAHash HashPackageName(const FString& LongPackageName, EExportPakNameHash NameHash = EExportPakNameHash::Utf8);
+
+private:
+	const FExportPakManifestPackage& GetPackage(int32 PackageIndex) const;
+
+	const FExportPakManifestRoot* GetRoot(int32 PackageIndex) const;
+
+	FString GetString(uint32 Offset) const;
+
+private:
+	const FExportPakManifestHeader* Header;
+	const FExportPakManifestPackage* Packages;
+	const FExportPakManifestRoot* Roots;
+	const uint32* Edges;
+	const ANSICHAR* StringData;
+};